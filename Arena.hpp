@@ -0,0 +1,148 @@
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+template<typename T, size_t ChunkSize = 256>
+class Arena {
+    // Append-only arena owning objects of type T in fixed size chunks. Objects are never freed individually,
+    // they are all destroyed together with the arena, and objects created one after another sit next to each other.
+private:
+    std::vector<T *> chunks; // raw storage for ChunkSize objects each
+    size_t count = 0; // constructed objects
+
+public:
+    Arena() = default;
+
+    Arena(const Arena &) = delete;
+
+    Arena &operator=(const Arena &) = delete;
+
+    ~Arena() {
+        // destroys every object and returns all chunks in one step
+        for (size_t i = 0; i < count; i++) {
+            (*this)[i].~T();
+        }
+        std::allocator<T> allocator;
+        for (T *chunk: chunks) {
+            allocator.deallocate(chunk, ChunkSize);
+        }
+    }
+
+    template<typename... Args>
+    T *create(Args &&... args) {
+        // constructs a new object at the end of the arena
+        if (count == chunks.size() * ChunkSize) {
+            chunks.push_back(std::allocator<T>().allocate(ChunkSize));
+        }
+        T *slot = chunks[count / ChunkSize] + count % ChunkSize;
+        new(slot) T(std::forward<Args>(args)...);
+        count++;
+        return slot;
+    }
+
+    T &operator[](size_t i) {
+        // i-th object in creation order
+        return chunks[i / ChunkSize][i % ChunkSize];
+    }
+
+    const T &operator[](size_t i) const {
+        // i-th object in creation order
+        return chunks[i / ChunkSize][i % ChunkSize];
+    }
+
+    size_t size() const {
+        // number of objects in arena
+        return count;
+    }
+
+    size_t chunk_count() const {
+        // number of chunk allocations made
+        return chunks.size();
+    }
+};
+
+template<typename T, size_t ChunkSize = 256>
+class Pool {
+    // Fixed size object pool. Freed slots go to a free list and are reused, chunks are returned to the
+    // system when the pool is destroyed. Live objects must be destroyed by the owner before that.
+private:
+    union Slot {
+        Slot *next; // next free slot
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    std::vector<Slot *> chunks; // ChunkSize slots each
+    Slot *free_list = nullptr;
+    size_t live = 0; // objects currently constructed
+
+    void grow() {
+        // allocates a chunk and threads its slots onto the free list
+        Slot *chunk = std::allocator<Slot>().allocate(ChunkSize);
+        chunks.push_back(chunk);
+        for (size_t i = ChunkSize; i > 0; i--) {
+            chunk[i - 1].next = free_list;
+            free_list = &chunk[i - 1];
+        }
+    }
+
+public:
+    Pool() = default;
+
+    Pool(const Pool &) = delete;
+
+    Pool &operator=(const Pool &) = delete;
+
+    ~Pool() {
+        // returns all chunks to the system
+        std::allocator<Slot> allocator;
+        for (Slot *chunk: chunks) {
+            allocator.deallocate(chunk, ChunkSize);
+        }
+    }
+
+    template<typename... Args>
+    T *create(Args &&... args) {
+        // constructs an object in a free slot
+        if (free_list == nullptr) {
+            grow();
+        }
+        Slot *slot = free_list;
+        free_list = slot->next; // read before the object overwrites it
+        T *object;
+        try {
+            object = new(slot->storage) T(std::forward<Args>(args)...);
+        } catch (...) {
+            slot->next = free_list;
+            free_list = slot;
+            throw;
+        }
+        live++;
+        return object;
+    }
+
+    void destroy(T *object) {
+        // destroys an object and puts its slot back on the free list
+        object->~T();
+        Slot *slot = reinterpret_cast<Slot *>(object);
+        slot->next = free_list;
+        free_list = slot;
+        live--;
+    }
+
+    size_t size() const {
+        // number of live objects
+        return live;
+    }
+
+    size_t chunk_count() const {
+        // number of chunk allocations made
+        return chunks.size();
+    }
+};
+
+#endif
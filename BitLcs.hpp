@@ -0,0 +1,161 @@
+#ifndef BITLCS_HPP
+#define BITLCS_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+class BitParallelLcs {
+    // Longest common subsequence of two short symbol sequences, such as the characters or words of a changed line,
+    // by Hyyrö's bit-vector recurrence: a row of the LCS table over A is kept as one bit per column, 64 columns per
+    // word, and each symbol of B advances the whole row with one add, and, or per word. Rows only give lengths, so
+    // the alignment is found Hirschberg-style: the top half of B runs forward over A and the bottom half backward,
+    // A is cut where the two lengths sum highest, and both halves are solved the same way. O(N*M/64) time and
+    // O(alphabet*N/64) memory, where the alphabet is the largest symbol + 1.
+private:
+    struct Range {
+        int a_begin;
+        int a_end;
+        int b_begin;
+        int b_end;
+    };
+
+    const std::vector<int> &a;
+    const std::vector<int> &b;
+    std::vector<char> &deleted;
+    std::vector<char> &inserted;
+    int words; // words per row over the whole of A
+    std::vector<uint64_t> forward_match; // bit i of the words of symbol s: A[a_begin + i] == s
+    std::vector<uint64_t> backward_match; // bit i of the words of symbol s: A[a_end - 1 - i] == s
+    std::vector<uint64_t> forward_row; // bit i clear iff column i raises the LCS over the columns before it
+    std::vector<uint64_t> backward_row;
+    std::vector<int> forward_lcs; // LCS of the first i columns of the range and the top half of its B
+    std::vector<int> backward_lcs; // LCS of the last i columns of the range and the bottom half of its B
+    std::vector<Range> pending; // ranges still to align
+
+    static uint64_t advance(uint64_t v, uint64_t m, uint64_t &carry) {
+        // next word of a row whose word was v, for a symbol matching the columns of m, carrying into the next word
+        uint64_t u = v & m;
+        uint64_t sum = v + u;
+        uint64_t carry_out = sum < v;
+        sum += carry;
+        carry_out |= sum < carry;
+        carry = carry_out;
+        return sum | (v & ~m);
+    }
+
+    static void count_lcs(const std::vector<uint64_t> &row, int width, std::vector<int> &lcs) {
+        // lcs[i] for i in [0, width]: the LCS over the first i columns, one for every clear bit before i
+        lcs.resize(width + 1);
+        lcs[0] = 0;
+        for (int i = 0; i < width; i++) {
+            lcs[i + 1] = lcs[i] + static_cast<int>(~row[i >> 6] >> (i & 63) & 1);
+        }
+    }
+
+    void lcs_rows(int width, int b_begin, int b_middle, int b_end) {
+        // forward_lcs over B[b_begin, b_middle) and backward_lcs over B[b_middle, b_end) read from the end, the
+        // bottom half being as long as the top or one longer. Both rows advance in the same loop, so their carry
+        // chains, each serial across words, overlap
+        int row_words = (width + 63) / 64;
+        forward_row.assign(row_words, ~uint64_t(0));
+        backward_row.assign(row_words, ~uint64_t(0));
+        for (int t = 0; t < b_end - b_middle; t++) {
+            const uint64_t *backward = backward_match.data() + static_cast<size_t>(b[b_end - 1 - t]) * words;
+            uint64_t forward_carry = 0;
+            uint64_t backward_carry = 0;
+            if (b_begin + t < b_middle) {
+                const uint64_t *forward = forward_match.data() + static_cast<size_t>(b[b_begin + t]) * words;
+                for (int w = 0; w < row_words; w++) {
+                    forward_row[w] = advance(forward_row[w], forward[w], forward_carry);
+                    backward_row[w] = advance(backward_row[w], backward[w], backward_carry);
+                }
+            } else {
+                for (int w = 0; w < row_words; w++) {
+                    backward_row[w] = advance(backward_row[w], backward[w], backward_carry);
+                }
+            }
+        }
+        count_lcs(forward_row, width, forward_lcs);
+        count_lcs(backward_row, width, backward_lcs);
+    }
+
+    void split(const Range &range) {
+        // marks range if it is trivial, else cuts A where the halves of B align best and queues both sides
+        int a_begin = range.a_begin, a_end = range.a_end, b_begin = range.b_begin, b_end = range.b_end;
+        while (a_begin < a_end && b_begin < b_end && a[a_begin] == b[b_begin]) {
+            a_begin++;
+            b_begin++;
+        }
+        while (a_begin < a_end && b_begin < b_end && a[a_end - 1] == b[b_end - 1]) {
+            a_end--;
+            b_end--;
+        }
+        if (a_begin == a_end || b_begin == b_end) {
+            std::fill(deleted.begin() + a_begin, deleted.begin() + a_end, 1);
+            std::fill(inserted.begin() + b_begin, inserted.begin() + b_end, 1);
+            return;
+        }
+        if (b_end - b_begin == 1) {
+            // one symbol of B, kept against its first occurrence in A if any
+            auto kept = std::find(a.begin() + a_begin, a.begin() + a_end, b[b_begin]);
+            std::fill(deleted.begin() + a_begin, deleted.begin() + a_end, 1);
+            if (kept != a.begin() + a_end) {
+                deleted[kept - a.begin()] = 0;
+            } else {
+                inserted[b_begin] = 1;
+            }
+            return;
+        }
+
+        int width = a_end - a_begin;
+        int b_middle = b_begin + (b_end - b_begin) / 2;
+        for (int i = 0; i < width; i++) {
+            forward_match[static_cast<size_t>(a[a_begin + i]) * words + (i >> 6)] |= uint64_t(1) << (i & 63);
+            backward_match[static_cast<size_t>(a[a_end - 1 - i]) * words + (i >> 6)] |= uint64_t(1) << (i & 63);
+        }
+        lcs_rows(width, b_begin, b_middle, b_end);
+        for (int i = 0; i < width; i++) {
+            forward_match[static_cast<size_t>(a[a_begin + i]) * words + (i >> 6)] = 0;
+            backward_match[static_cast<size_t>(a[a_end - 1 - i]) * words + (i >> 6)] = 0;
+        }
+
+        int cut = 0;
+        for (int i = 1; i <= width; i++) {
+            if (forward_lcs[i] + backward_lcs[width - i] > forward_lcs[cut] + backward_lcs[width - cut]) {
+                cut = i;
+            }
+        }
+        pending.push_back({a_begin, a_begin + cut, b_begin, b_middle});
+        pending.push_back({a_begin + cut, a_end, b_middle, b_end});
+    }
+
+public:
+    BitParallelLcs(const std::vector<int> &A, const std::vector<int> &B, std::vector<char> &deleted,
+                   std::vector<char> &inserted) : a(A), b(B), deleted(deleted), inserted(inserted),
+                                                  words(static_cast<int>((A.size() + 63) / 64)) {
+        // prepares to mark an edit script of A into B, whose symbols are small non-negative ints
+        int alphabet = 0;
+        for (const std::vector<int> *symbols: {&A, &B}) {
+            for (int symbol: *symbols) {
+                alphabet = std::max(alphabet, symbol + 1);
+            }
+        }
+        forward_match.assign(static_cast<size_t>(alphabet) * words, 0);
+        backward_match.assign(static_cast<size_t>(alphabet) * words, 0);
+        deleted.assign(A.size(), 0);
+        inserted.assign(B.size(), 0);
+    }
+
+    void compare() {
+        // marks deleted[i] and inserted[j] for every symbol of A and B outside a longest common subsequence
+        pending.push_back({0, static_cast<int>(a.size()), 0, static_cast<int>(b.size())});
+        while (!(pending.empty())) {
+            Range range = pending.back();
+            pending.pop_back();
+            split(range);
+        }
+    }
+};
+
+#endif
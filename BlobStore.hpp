@@ -0,0 +1,390 @@
+#ifndef BLOBSTORE_HPP
+#define BLOBSTORE_HPP
+
+#include "HashMap.hpp"
+#include "Sha256.hpp"
+#include "Lz.hpp"
+#include <string>
+#include <string_view>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <filesystem>
+#include <stdexcept>
+
+struct Blob {
+    // immutable content shared by every version with the same text
+    std::string owned; // content, or its compressed form, unless the blob is mapped or evicted
+    std::string_view data; // content, pointing into owned or into the mapping, empty while compressed or evicted
+    std::string digest; // SHA-256 of data
+    size_t size; // bytes of content, also while compressed or evicted
+    size_t held = 0; // bytes of owned kept in memory
+    int refcount;
+    bool mapped; // data views a mapped checkpoint, such blobs are never compressed or evicted
+    bool resident; // owned is in memory
+    bool compressed = false; // owned holds the LZ compressed content
+    bool cold = false; // untouched for a while, kept in the cold list
+    bool on_disk; // a copy is in the cold store
+    bool disk_compressed = false; // the copy in the cold store is compressed
+    uint64_t last_used = 0; // maintenance tick of the last fetch
+    Blob *lru_prev = nullptr; // more recently used blob of the same list
+    Blob *lru_next = nullptr; // less recently used blob of the same list
+
+    Blob(const std::string &data, const std::string &digest) {
+        owned = data;
+        this->data = owned;
+        this->digest = digest;
+        size = data.size();
+        held = size;
+        refcount = 0;
+        mapped = false;
+        resident = true;
+        on_disk = false;
+    }
+
+    Blob(std::string_view mapped, const std::string &digest) {
+        // zero-copy blob over memory that outlives it
+        data = mapped;
+        this->digest = digest;
+        size = mapped.size();
+        refcount = 0;
+        this->mapped = true;
+        resident = true;
+        on_disk = false;
+    }
+
+    Blob(const Blob &) = delete;
+
+    Blob &operator=(const Blob &) = delete;
+};
+
+inline std::string to_hex(const std::string &bytes) {
+    // lowercase hexadecimal spelling of bytes
+    static constexpr char digits[] = "0123456789abcdef";
+    std::string out;
+    out.reserve(bytes.size() * 2);
+    for (unsigned char c: bytes) {
+        out.push_back(digits[c >> 4]);
+        out.push_back(digits[c & 15]);
+    }
+    return out;
+}
+
+class BlobStore {
+    // Content addressed store of reference counted blobs, keyed by SHA-256 digest. Blobs held in memory are kept
+    // in two LRU lists: hot blobs, and cold blobs untouched for compress_after maintenance ticks, which are
+    // LZ compressed when that saves space. With a cold store enabled, the least recently used blobs (cold ones
+    // first) are written to disk and dropped from memory once they exceed the memory budget. Compressed and
+    // evicted blobs are restored transparently on their next fetch
+private:
+    struct LruList {
+        Blob *head = nullptr; // most recently used
+        Blob *tail = nullptr; // least recently used
+
+        void unlink(Blob *blob) {
+            (blob->lru_prev != nullptr ? blob->lru_prev->lru_next : head) = blob->lru_next;
+            (blob->lru_next != nullptr ? blob->lru_next->lru_prev : tail) = blob->lru_prev;
+            blob->lru_prev = nullptr;
+            blob->lru_next = nullptr;
+        }
+
+        void push_front(Blob *blob) {
+            blob->lru_next = head;
+            (head != nullptr ? head->lru_prev : tail) = blob;
+            head = blob;
+        }
+    };
+
+    HashMap<std::string, Blob *> blobs; // digest -> blob
+    size_t stored_bytes = 0; // bytes held by unique blobs
+    size_t references = 0; // live references to blobs
+    size_t referenced_bytes = 0; // bytes all references would hold without deduplication
+    size_t mapped_bytes = 0; // bytes of unique blobs viewed in place in a mapped checkpoint
+    std::string cold_directory; // empty if the cold store is off
+    size_t memory_budget = SIZE_MAX; // resident bytes allowed after maintain()
+    uint64_t compress_after = 0; // ticks a blob stays hot without being fetched, 0 if compression is off
+    uint64_t clock = 0; // maintenance ticks so far
+    size_t resident_bytes = 0; // bytes of unmapped blobs held in memory, compressed or not
+    LruList hot; // resident blobs fetched recently
+    LruList cold; // resident blobs not fetched for compress_after ticks
+    size_t hits = 0; // fetches of resident blobs
+    size_t misses = 0; // fetches that read a blob back from the cold store
+    size_t evictions = 0; // blobs dropped from memory
+    size_t compressed_blobs = 0; // blobs currently held compressed
+    size_t compressed_from = 0; // content bytes of blobs currently held compressed
+    size_t compressed_to = 0; // their compressed bytes
+    size_t decompressions = 0; // compressed blobs restored on fetch
+
+    std::string cold_path(const Blob *blob) const {
+        // file holding the evicted content of blob
+        return cold_directory + "/" + to_hex(blob->digest);
+    }
+
+    LruList &list_of(const Blob *blob) {
+        return blob->cold ? cold : hot;
+    }
+
+    void set_owned(Blob *blob, std::string bytes, bool is_compressed) {
+        // replaces what blob holds in memory, keeping the counters in step
+        if (blob->compressed) {
+            compressed_blobs--;
+            compressed_from -= blob->size;
+            compressed_to -= blob->held;
+        }
+        resident_bytes -= blob->held;
+        blob->owned = std::move(bytes);
+        blob->compressed = is_compressed;
+        blob->held = blob->owned.size();
+        blob->data = is_compressed ? std::string_view() : std::string_view(blob->owned);
+        resident_bytes += blob->held;
+        if (is_compressed) {
+            compressed_blobs++;
+            compressed_from += blob->size;
+            compressed_to += blob->held;
+        }
+    }
+
+    void make_cold(Blob *blob) {
+        // moves a hot blob to the cold list, compressing it if that saves space
+        hot.unlink(blob);
+        std::string packed = lz_compress(blob->data);
+        if (packed.size() < blob->size) {
+            set_owned(blob, std::move(packed), true);
+        }
+        blob->cold = true;
+        cold.push_front(blob);
+    }
+
+    void evict(Blob *blob) {
+        // writes blob to the cold store as held in memory if it is not there yet and drops it from memory
+        if (!(blob->on_disk)) {
+            std::string path = cold_path(blob);
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            out.write(blob->owned.data(), static_cast<std::streamsize>(blob->held));
+            if (!(out.flush())) {
+                std::remove(path.c_str());
+                throw std::runtime_error("Cannot write blob to cold store '" + cold_directory + "'.");
+            }
+            blob->on_disk = true;
+            blob->disk_compressed = blob->compressed;
+        }
+        list_of(blob).unlink(blob);
+        set_owned(blob, std::string(), false);
+        blob->data = {};
+        blob->resident = false;
+        blob->cold = false;
+        evictions++;
+    }
+
+public:
+    BlobStore() = default;
+
+    BlobStore(const BlobStore &) = delete;
+
+    BlobStore &operator=(const BlobStore &) = delete;
+
+    void enable_cold_store(const std::string &directory, size_t budget) {
+        // spills blobs beyond budget resident bytes to directory from now on
+        std::filesystem::create_directories(directory);
+        cold_directory = directory;
+        memory_budget = budget;
+    }
+
+    bool has_cold_store() const {
+        return !cold_directory.empty();
+    }
+
+    void enable_compression(uint64_t ticks) {
+        // compresses blobs not fetched during the last ticks maintenance ticks, 0 turns compression off
+        compress_after = ticks;
+    }
+
+    bool has_compression() const {
+        return compress_after != 0;
+    }
+
+    Blob *intern(const std::string &data) {
+        // returns the blob holding data, creating it if new, and takes a reference to it
+        std::string digest = sha256(data);
+        Blob *blob;
+        if (blobs.count(digest)) {
+            blob = blobs.get(digest);
+        } else {
+            blob = new Blob(data, digest);
+            blobs.insert(digest, blob);
+            stored_bytes += data.size();
+            resident_bytes += data.size();
+            blob->last_used = clock;
+            hot.push_front(blob);
+        }
+        retain(blob);
+        return blob;
+    }
+
+    Blob *adopt(std::string_view mapped, const std::string &digest) {
+        // returns the blob with the given digest, creating a zero-copy view over mapped if new, and takes a
+        // reference to it. mapped must stay valid as long as the blob is referenced
+        Blob *blob;
+        if (blobs.count(digest)) {
+            blob = blobs.get(digest);
+        } else {
+            blob = new Blob(mapped, digest);
+            blobs.insert(digest, blob);
+            stored_bytes += mapped.size();
+            mapped_bytes += mapped.size();
+        }
+        retain(blob);
+        return blob;
+    }
+
+    std::string_view fetch(Blob *blob) {
+        // content of blob, decompressed or read back from the cold store if needed. The view stays valid until
+        // the next maintain()
+        if (blob->mapped) {
+            return blob->data;
+        }
+        if (blob->resident) {
+            hits++;
+            list_of(blob).unlink(blob);
+            if (blob->compressed) {
+                set_owned(blob, lz_decompress(blob->owned, blob->size), false);
+                decompressions++;
+            }
+        } else {
+            std::ifstream in(cold_path(blob), std::ios::binary);
+            if (!in) {
+                throw std::runtime_error("Cannot read blob from cold store '" + cold_directory + "'.");
+            }
+            std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+            if (blob->disk_compressed) {
+                bytes = lz_decompress(bytes, blob->size);
+            }
+            if (bytes.size() != blob->size) {
+                throw std::runtime_error("Cannot read blob from cold store '" + cold_directory + "'.");
+            }
+            set_owned(blob, std::move(bytes), false);
+            blob->resident = true;
+            misses++;
+        }
+        blob->cold = false;
+        blob->last_used = clock;
+        hot.push_front(blob);
+        return blob->data;
+    }
+
+    void maintain() {
+        // advances the maintenance clock, compresses blobs that went cold and evicts least recently used blobs
+        // until the resident ones fit the memory budget. Views returned by fetch() before this call may be
+        // invalidated
+        clock++;
+        if (compress_after != 0) {
+            while (hot.tail != nullptr && hot.tail->last_used + compress_after <= clock) {
+                make_cold(hot.tail);
+            }
+        }
+        while (resident_bytes > memory_budget && (cold.tail != nullptr || hot.tail != nullptr)) {
+            evict(cold.tail != nullptr ? cold.tail : hot.tail);
+        }
+    }
+
+    void retain(Blob *blob) {
+        // takes another reference to blob
+        blob->refcount++;
+        references++;
+        referenced_bytes += blob->size;
+    }
+
+    void release(Blob *blob) {
+        // drops a reference to blob, freeing it when no version uses it
+        if (blob->refcount <= 0) {
+            throw std::logic_error("Blob released more times than retained.");
+        }
+        blob->refcount--;
+        references--;
+        referenced_bytes -= blob->size;
+        if (blob->refcount == 0) {
+            blobs.remove(blob->digest);
+            stored_bytes -= blob->size;
+            if (blob->mapped) {
+                mapped_bytes -= blob->size;
+            } else if (blob->resident) {
+                list_of(blob).unlink(blob);
+                set_owned(blob, std::string(), false);
+            }
+            if (blob->on_disk) {
+                std::remove(cold_path(blob).c_str());
+            }
+            delete blob;
+        }
+    }
+
+    size_t unique_blobs() const {
+        // number of distinct contents stored
+        return blobs.size();
+    }
+
+    size_t reference_count() const {
+        // number of live references to blobs
+        return references;
+    }
+
+    size_t bytes_stored() const {
+        // bytes held by unique blobs
+        return stored_bytes;
+    }
+
+    size_t bytes_referenced() const {
+        // bytes that would be held if every reference owned a copy
+        return referenced_bytes;
+    }
+
+    size_t bytes_mapped() const {
+        // bytes of unique blobs served straight from a mapped checkpoint
+        return mapped_bytes;
+    }
+
+    size_t bytes_resident() const {
+        // bytes of unmapped blobs currently in memory, compressed or not
+        return resident_bytes;
+    }
+
+    size_t budget() const {
+        // resident bytes allowed after maintain()
+        return memory_budget;
+    }
+
+    size_t cache_hits() const {
+        return hits;
+    }
+
+    size_t cache_misses() const {
+        return misses;
+    }
+
+    size_t cache_evictions() const {
+        return evictions;
+    }
+
+    size_t compressed_count() const {
+        // blobs currently held compressed
+        return compressed_blobs;
+    }
+
+    double compression_ratio() const {
+        // content bytes per compressed byte of the blobs currently held compressed
+        return compressed_to == 0 ? 1.0 : static_cast<double>(compressed_from) / compressed_to;
+    }
+
+    size_t decompression_count() const {
+        // compressed blobs restored on fetch
+        return decompressions;
+    }
+
+    double dedup_ratio() const {
+        // referenced bytes per stored byte
+        return stored_bytes == 0 ? 1.0 : static_cast<double>(referenced_bytes) / stored_bytes;
+    }
+};
+
+#endif
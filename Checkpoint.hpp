@@ -0,0 +1,269 @@
+#ifndef CHECKPOINT_HPP
+#define CHECKPOINT_HPP
+
+#include "Journal.hpp"
+#include "HashMap.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <fcntl.h>
+
+#if defined(_WIN32)
+#include <io.h>
+#include <fstream>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// first and last 8 bytes of a checkpoint image
+constexpr char CHECKPOINT_MAGIC[8] = {'C', 'G', 'F', 'S', 'I', 'M', 'G', '4'};
+// images store numbers in the byte order of the machine that wrote them, this tag detects a mismatch
+constexpr uint32_t CHECKPOINT_BYTE_ORDER = 0x01020304;
+
+struct ImageNode {
+    // rope node as stored in a checkpoint image, children always refer to earlier nodes
+    int32_t blob; // index of the piece source for leaves, -1 for internal nodes
+    int32_t left; // internal nodes only
+    int32_t right; // internal nodes only
+    int32_t reserved; // zero
+    uint64_t offset; // leaves only
+    uint64_t length;
+};
+
+struct PointerHasher {
+    // hash for HashMap keys that are pointers
+    template<typename T>
+    uint64_t operator()(const T *pointer) const {
+        return hash_int(static_cast<uint64_t>(reinterpret_cast<uintptr_t>(pointer)));
+    }
+};
+
+class MappedFile {
+    // Read-only view of a whole file, memory mapped so pages are only loaded when first touched
+private:
+    const char *bytes = nullptr;
+    size_t length = 0;
+#if defined(_WIN32)
+    std::string contents; // no mmap here, the file is read into memory once instead
+#endif
+
+public:
+    explicit MappedFile(const std::string &path) {
+#if defined(_WIN32)
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            throw std::runtime_error("Cannot open checkpoint '" + path + "'.");
+        }
+        contents.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        bytes = contents.data();
+        length = contents.size();
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot open checkpoint '" + path + "'.");
+        }
+        struct stat info;
+        if (::fstat(fd, &info) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Cannot read checkpoint '" + path + "'.");
+        }
+        length = static_cast<size_t>(info.st_size);
+        if (length > 0) {
+            void *mapping = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping == MAP_FAILED) {
+                ::close(fd);
+                throw std::runtime_error("Cannot map checkpoint '" + path + "'.");
+            }
+            bytes = static_cast<const char *>(mapping);
+        }
+        ::close(fd); // the mapping stays valid after the descriptor is closed
+#endif
+    }
+
+    MappedFile(const MappedFile &) = delete;
+
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    ~MappedFile() {
+#if !defined(_WIN32)
+        if (bytes != nullptr) {
+            ::munmap(const_cast<char *>(bytes), length);
+        }
+#endif
+    }
+
+    const char *data() const {
+        return bytes;
+    }
+
+    size_t size() const {
+        return length;
+    }
+};
+
+class ImageWriter {
+    // Buffered writer of a checkpoint image. The image goes to path.tmp and is only renamed over path by commit(),
+    // so a crash never leaves a partial image behind and a mapping of the previous image stays intact
+private:
+    std::string path;
+    std::string temporary;
+    int fd;
+    std::string buffer;
+
+    void flush() {
+        // writes buffered bytes to the file
+        size_t done = 0;
+        while (done < buffer.size()) {
+#if defined(_WIN32)
+            int written = _write(fd, buffer.data() + done, static_cast<unsigned int>(buffer.size() - done));
+#else
+            ssize_t written = ::write(fd, buffer.data() + done, buffer.size() - done);
+#endif
+            if (written <= 0) {
+                throw std::runtime_error("Failed to write checkpoint '" + temporary + "'.");
+            }
+            done += static_cast<size_t>(written);
+        }
+        buffer.clear();
+    }
+
+public:
+    explicit ImageWriter(const std::string &path) {
+        this->path = path;
+        temporary = path + ".tmp";
+#if defined(_WIN32)
+        fd = _open(temporary.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, 0644);
+#else
+        fd = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+#endif
+        if (fd < 0) {
+            throw std::runtime_error("Cannot create checkpoint '" + temporary + "'.");
+        }
+    }
+
+    ImageWriter(const ImageWriter &) = delete;
+
+    ImageWriter &operator=(const ImageWriter &) = delete;
+
+    ~ImageWriter() {
+        // abandons an image that was not committed
+        if (fd >= 0) {
+#if defined(_WIN32)
+            _close(fd);
+#else
+            ::close(fd);
+#endif
+            std::remove(temporary.c_str());
+        }
+    }
+
+    void put_bytes(const void *data, size_t size) {
+        buffer.append(static_cast<const char *>(data), size);
+        if (buffer.size() >= (size_t(1) << 20)) {
+            flush();
+        }
+    }
+
+    template<typename T>
+    void put(const T &value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        put_bytes(&value, sizeof(T));
+    }
+
+    template<typename T>
+    void put_array(const std::vector<T> &values) {
+        // writes the elements back to back, the count is written separately
+        static_assert(std::is_trivially_copyable_v<T>);
+        put_bytes(values.data(), values.size() * sizeof(T));
+    }
+
+    void put_string(std::string_view text) {
+        put<uint64_t>(text.size());
+        put_bytes(text.data(), text.size());
+    }
+
+    void commit() {
+        // makes the image durable and atomically replaces path with it
+        flush();
+#if defined(_WIN32)
+        bool synced = _commit(fd) == 0;
+        _close(fd);
+#else
+        bool synced = ::fsync(fd) == 0;
+        ::close(fd);
+#endif
+        fd = -1;
+        if (!synced) {
+            std::remove(temporary.c_str());
+            throw std::runtime_error("Failed to fsync checkpoint '" + temporary + "'.");
+        }
+        replace_file(temporary, path);
+    }
+};
+
+class ImageReader {
+    // Bounds checked cursor over a checkpoint image
+private:
+    const char *data;
+    size_t size;
+    size_t pos = 0;
+
+    void need(size_t count, size_t element_size = 1) const {
+        if (count > (size - pos) / element_size) {
+            throw std::runtime_error("Checkpoint image is truncated or corrupt.");
+        }
+    }
+
+public:
+    ImageReader(const char *data, size_t size) {
+        this->data = data;
+        this->size = size;
+    }
+
+    std::string_view get_view(size_t count) {
+        // next count bytes, pointing into the image
+        need(count);
+        std::string_view view(data + pos, count);
+        pos += count;
+        return view;
+    }
+
+    template<typename T>
+    T get() {
+        static_assert(std::is_trivially_copyable_v<T>);
+        need(sizeof(T));
+        T value;
+        std::memcpy(&value, data + pos, sizeof(T));
+        pos += sizeof(T);
+        return value;
+    }
+
+    template<typename T>
+    void get_array(std::vector<T> &values, size_t count) {
+        // reads count elements written by ImageWriter::put_array
+        static_assert(std::is_trivially_copyable_v<T>);
+        need(count, sizeof(T));
+        values.resize(count);
+        if (count > 0) {
+            std::memcpy(values.data(), data + pos, count * sizeof(T));
+        }
+        pos += count * sizeof(T);
+    }
+
+    std::string_view get_string() {
+        return get_view(get<uint64_t>());
+    }
+
+    bool done() const {
+        // if the whole image was read
+        return pos == size;
+    }
+};
+
+#endif
@@ -0,0 +1,118 @@
+#ifndef CONCURRENTHASHMAP_HPP
+#define CONCURRENTHASHMAP_HPP
+
+#include "HashMap.hpp"
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+
+template<typename K, typename V, typename Hasher = CustomHasher<K>, size_t ShardCount = 64>
+class ConcurrentHashMap {
+    // Lock-striped HashMap that threads can share: keys are spread over ShardCount shards by the top bits of their
+    // hash, each a HashMap behind its own reader-writer lock. Readers of a shard never block each other and a writer
+    // only blocks the shard it changes. Values are returned by copy since a reference would outlive the lock.
+private:
+    static_assert(std::has_single_bit(ShardCount), "Shard count must be a power of two.");
+    static constexpr int SHARD_BITS = std::countr_zero(ShardCount);
+
+    struct alignas(64) Shard {
+        // own cache line so locking one shard does not invalidate its neighbours
+        mutable std::shared_mutex lock;
+        HashMap<K, V, Hasher> map;
+    };
+
+    std::unique_ptr<Shard[]> shards;
+    Hasher hasher;
+
+    template<typename Q>
+    Shard &shard_of(const Q &key) const {
+        // the HashMap inside uses the low bits of the same hash, so the shard takes the top ones
+        if constexpr (SHARD_BITS == 0) {
+            return shards[0];
+        } else {
+            return shards[static_cast<uint64_t>(hasher(key)) >> (64 - SHARD_BITS)];
+        }
+    }
+
+public:
+    ConcurrentHashMap() : shards(new Shard[ShardCount]) {
+        // constructor
+    }
+
+    ConcurrentHashMap(const ConcurrentHashMap &) = delete;
+
+    ConcurrentHashMap &operator=(const ConcurrentHashMap &) = delete;
+
+    size_t size() const {
+        // number of keys, exact only while no other thread is writing
+        size_t total = 0;
+        for (size_t i = 0; i < ShardCount; i++) {
+            std::shared_lock guard(shards[i].lock);
+            total += shards[i].map.size();
+        }
+        return total;
+    }
+
+    template<typename Q>
+    bool count(const Q &key) const {
+        // checks if key is present
+        Shard &shard = shard_of(key);
+        std::shared_lock guard(shard.lock);
+        return shard.map.count(key);
+    }
+
+    template<typename Q>
+    V get(const Q &key) const {
+        // returns a copy of the value of key if found
+        Shard &shard = shard_of(key);
+        std::shared_lock guard(shard.lock);
+        return shard.map.get(key);
+    }
+
+    void insert(const K &key, const V &value) {
+        // updates/ inserts value into key
+        Shard &shard = shard_of(key);
+        std::unique_lock guard(shard.lock);
+        shard.map.insert(key, value);
+    }
+
+    bool insert_new(const K &key, const V &value) {
+        // inserts key only if it is absent, returns false if another thread got there first
+        Shard &shard = shard_of(key);
+        std::unique_lock guard(shard.lock);
+        if (shard.map.count(key)) {
+            return false;
+        }
+        shard.map.insert(key, value);
+        return true;
+    }
+
+    template<typename Q>
+    void remove(const Q &key) {
+        // removes key:value if present
+        Shard &shard = shard_of(key);
+        std::unique_lock guard(shard.lock);
+        shard.map.remove(key);
+    }
+
+    void clear() {
+        // deletes every key:value pair
+        for (size_t i = 0; i < ShardCount; i++) {
+            std::unique_lock guard(shards[i].lock);
+            shards[i].map.clear();
+        }
+    }
+
+    template<typename Visitor>
+    void for_each(Visitor visit) const {
+        // calls visit(key, value) for every key:value pair, holding one shard's read lock at a time
+        for (size_t i = 0; i < ShardCount; i++) {
+            std::shared_lock guard(shards[i].lock);
+            shards[i].map.for_each(visit);
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,264 @@
+#ifndef COUNTBUCKETS_HPP
+#define COUNTBUCKETS_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+class CountBuckets {
+    // Small non-negative int keys, such as interned file IDs, each with an int count, kept in descending order of
+    // count the way an LFU cache keeps its frequencies: one bucket per distinct count, buckets linked from the
+    // highest count down, each holding a doubly linked list of its keys. Changing a count by one moves the key to
+    // the neighbouring bucket in O(1) and the first k keys are read in O(k). Among equal counts, a key that
+    // reached the count by growing comes after the keys already there.
+private:
+    static constexpr int NONE = -1; // end of a list
+    static constexpr int ABSENT = -2; // bucket of a key not present
+
+    struct Bucket {
+        int count;
+        int head; // first key
+        int tail; // last key
+        int higher; // bucket with the next higher count
+        int lower; // bucket with the next lower count, or the next free bucket
+    };
+
+    struct Node {
+        int bucket; // ABSENT if the key is not present
+        int prev;
+        int next;
+    };
+
+    std::vector<Node> nodes; // indexed by key
+    std::vector<Bucket> buckets;
+    int highest = NONE; // bucket with the highest count
+    int lowest = NONE; // bucket with the lowest count
+    int free_buckets = NONE; // emptied buckets, reused before growing
+    size_t current_size = 0;
+
+    void reserve_key(int key) {
+        // grows the node array to hold key
+        if (key < 0) {
+            throw std::invalid_argument("CountBuckets keys must be non-negative.");
+        }
+        if (static_cast<size_t>(key) >= nodes.size()) {
+            nodes.resize(std::max(static_cast<size_t>(key) + 1, nodes.size() * 2), Node{ABSENT, NONE, NONE});
+        }
+    }
+
+    int new_bucket(int count, int higher, int lower) {
+        // links an empty bucket for count between higher and lower
+        int b;
+        if (free_buckets != NONE) {
+            b = free_buckets;
+            free_buckets = buckets[b].lower;
+        } else {
+            b = static_cast<int>(buckets.size());
+            buckets.emplace_back();
+        }
+        buckets[b] = Bucket{count, NONE, NONE, higher, lower};
+        if (higher == NONE) {
+            highest = b;
+        } else {
+            buckets[higher].lower = b;
+        }
+        if (lower == NONE) {
+            lowest = b;
+        } else {
+            buckets[lower].higher = b;
+        }
+        return b;
+    }
+
+    void free_bucket(int b) {
+        // unlinks an empty bucket
+        if (buckets[b].higher == NONE) {
+            highest = buckets[b].lower;
+        } else {
+            buckets[buckets[b].higher].lower = buckets[b].lower;
+        }
+        if (buckets[b].lower == NONE) {
+            lowest = buckets[b].higher;
+        } else {
+            buckets[buckets[b].lower].higher = buckets[b].higher;
+        }
+        buckets[b].lower = free_buckets;
+        free_buckets = b;
+    }
+
+    void link(int key, int b, bool front) {
+        // adds key to the front or back of bucket b
+        Node &node = nodes[key];
+        Bucket &bucket = buckets[b];
+        node.bucket = b;
+        if (front) {
+            node.prev = NONE;
+            node.next = bucket.head;
+            if (bucket.head == NONE) {
+                bucket.tail = key;
+            } else {
+                nodes[bucket.head].prev = key;
+            }
+            bucket.head = key;
+        } else {
+            node.prev = bucket.tail;
+            node.next = NONE;
+            if (bucket.tail == NONE) {
+                bucket.head = key;
+            } else {
+                nodes[bucket.tail].next = key;
+            }
+            bucket.tail = key;
+        }
+    }
+
+    void unlink(int key) {
+        // takes key out of its bucket, leaving the bucket linked even if it is now empty
+        Node &node = nodes[key];
+        Bucket &bucket = buckets[node.bucket];
+        if (node.prev == NONE) {
+            bucket.head = node.next;
+        } else {
+            nodes[node.prev].next = node.next;
+        }
+        if (node.next == NONE) {
+            bucket.tail = node.prev;
+        } else {
+            nodes[node.next].prev = node.prev;
+        }
+        node.bucket = ABSENT;
+    }
+
+    void place(int key, int count, int higher, int lower, bool front) {
+        // links key into the bucket for count, which lies between buckets higher and lower if it does not exist
+        int b;
+        if (higher != NONE && buckets[higher].count == count) {
+            b = higher;
+        } else if (lower != NONE && buckets[lower].count == count) {
+            b = lower;
+        } else {
+            b = new_bucket(count, higher, lower);
+        }
+        link(key, b, front);
+    }
+
+    void move(int key, int count) {
+        // moves a present key to count, one step up or down, behind the keys already there when going up and in
+        // front of them when going down
+        int b = nodes[key].bucket;
+        bool up = count > buckets[b].count;
+        int higher = buckets[b].higher;
+        int lower = buckets[b].lower;
+        unlink(key);
+        if (buckets[b].head == NONE) {
+            free_bucket(b);
+        } else if (up) {
+            lower = b;
+        } else {
+            higher = b;
+        }
+        place(key, count, higher, lower, !up);
+    }
+
+public:
+    size_t size() const {
+        // number of keys
+        return current_size;
+    }
+
+    bool empty() const {
+        // if there are no keys
+        return current_size == 0;
+    }
+
+    bool contains(int key) const {
+        // if key is present
+        return key >= 0 && static_cast<size_t>(key) < nodes.size() && nodes[key].bucket != ABSENT;
+    }
+
+    int get(int key) const {
+        // returns count of key if present
+        if (!(contains(key))) {
+            throw std::out_of_range("Key not in CountBuckets.");
+        }
+        return buckets[nodes[key].bucket].count;
+    }
+
+    void insert(int key, int count) {
+        // adds an absent key after every key with the same count, searching up from the lowest count, so O(1)
+        // when count is no higher than any other
+        reserve_key(key);
+        if (nodes[key].bucket != ABSENT) {
+            throw std::invalid_argument("Key already exists in CountBuckets.");
+        }
+        int higher = lowest; // lowest bucket with at least count
+        while (higher != NONE && buckets[higher].count < count) {
+            higher = buckets[higher].higher;
+        }
+        int lower = higher == NONE ? highest : buckets[higher].lower;
+        place(key, count, higher, lower, false);
+        current_size++;
+    }
+
+    void update(int key, int count) {
+        // sets the count of a present key, O(1) when it changes by one
+        if (!(contains(key))) {
+            throw std::out_of_range("Key not in CountBuckets.");
+        }
+        int old_count = get(key);
+        if (count == old_count) {
+            return;
+        }
+        if (count == old_count + 1 || count == old_count - 1) {
+            move(key, count);
+        } else {
+            remove(key);
+            insert(key, count);
+        }
+    }
+
+    void increment(int key) {
+        // adds one to the count of a present key
+        update(key, get(key) + 1);
+    }
+
+    void decrement(int key) {
+        // subtracts one from the count of a present key
+        update(key, get(key) - 1);
+    }
+
+    void remove(int key) {
+        // removes key if present
+        if (!(contains(key))) {
+            return;
+        }
+        int b = nodes[key].bucket;
+        unlink(key);
+        if (buckets[b].head == NONE) {
+            free_bucket(b);
+        }
+        current_size--;
+    }
+
+    void clear() {
+        // removes every key, keeping the node array
+        std::fill(nodes.begin(), nodes.end(), Node{ABSENT, NONE, NONE});
+        buckets.clear();
+        highest = lowest = free_buckets = NONE;
+        current_size = 0;
+    }
+
+    template<typename Visitor>
+    void for_each(Visitor visit, size_t limit = SIZE_MAX) const {
+        // calls visit(key, count) for the first limit keys in descending order of count
+        for (int b = highest; b != NONE && limit > 0; b = buckets[b].lower) {
+            for (int key = buckets[b].head; key != NONE && limit > 0; key = nodes[key].next, limit--) {
+                visit(key, buckets[b].count);
+            }
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,117 @@
+#ifndef DELTA_HPP
+#define DELTA_HPP
+
+#include "Diff.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstddef>
+
+struct DeltaOp {
+    // one step of an edit script: copy a byte range of the base, or append literal text
+    bool copy;
+    size_t offset; // start of copied range in base (copy only)
+    size_t length; // length of copied range (copy only)
+    std::string literal; // inserted text (literal only)
+
+    static DeltaOp copy_op(size_t offset, size_t length) {
+        return {true, offset, length, ""};
+    }
+
+    static DeltaOp literal_op(const std::string &text) {
+        return {false, 0, 0, text};
+    }
+};
+
+inline std::vector<std::string_view> getLineVec(std::string_view input) {
+    // splits a string into views of its lines, keeping the '\n' terminators so the text can be rebuilt exactly
+    std::vector<std::string_view> lines;
+    size_t start = 0;
+    while (start < input.size()) {
+        size_t end = input.find('\n', start);
+        end = (end == std::string::npos) ? input.size() : end + 1;
+        lines.push_back(input.substr(start, end - start));
+        start = end;
+    }
+    return lines;
+}
+
+inline void append_copy(std::vector<DeltaOp> &ops, size_t offset, size_t length) {
+    // appends a copy op, merging it with the previous one when the ranges are contiguous
+    if (length == 0) {
+        return;
+    }
+    if (!ops.empty() && ops.back().copy && ops.back().offset + ops.back().length == offset) {
+        ops.back().length += length;
+    } else {
+        ops.push_back(DeltaOp::copy_op(offset, length));
+    }
+}
+
+inline void append_literal(std::vector<DeltaOp> &ops, std::string_view text) {
+    // appends a literal op, merging it with the previous literal
+    if (text.empty()) {
+        return;
+    }
+    if (!ops.empty() && !ops.back().copy) {
+        ops.back().literal += text;
+    } else {
+        ops.push_back(DeltaOp::literal_op(std::string(text)));
+    }
+}
+
+inline std::vector<DeltaOp> encode_delta(const std::string &base, const std::string &target) {
+    // builds an edit script turning base into target using the line diff from Diff.hpp. Lines are views into base
+    // and target; the changed middle is interned and diffed by Myers in linear space, so no size needs a fallback
+    std::vector<std::string_view> A = getLineVec(base);
+    std::vector<std::string_view> B = getLineVec(target);
+    auto offset = [&](size_t i) { return static_cast<size_t>(A[i].data() - base.data()); };
+
+    // common leading and trailing lines are copied directly, only the middle is diffed
+    size_t prefix = 0;
+    while (prefix < A.size() && prefix < B.size() && A[prefix] == B[prefix]) {
+        prefix++;
+    }
+    size_t suffix = 0;
+    while (suffix < A.size() - prefix && suffix < B.size() - prefix &&
+           A[A.size() - 1 - suffix] == B[B.size() - 1 - suffix]) {
+        suffix++;
+    }
+    size_t a_size = A.size() - prefix - suffix;
+    size_t b_size = B.size() - prefix - suffix;
+
+    std::vector<int> a_ids(a_size), b_ids(b_size);
+    if (a_size > 0 && b_size > 0) {
+        LineIds ids(a_size + b_size);
+        for (size_t i = 0; i < a_size; i++) {
+            a_ids[i] = ids.intern(A[prefix + i]);
+        }
+        for (size_t j = 0; j < b_size; j++) {
+            b_ids[j] = ids.intern(B[prefix + j]);
+        }
+    }
+    std::vector<char> deleted, inserted;
+    mark_edits(a_ids, b_ids, deleted, inserted, DiffAlgorithm::Myers);
+
+    std::vector<DeltaOp> ops;
+    append_copy(ops, 0, prefix < A.size() ? offset(prefix) : base.size());
+    size_t i = 0;
+    size_t j = 0;
+    while (i < a_size || j < b_size) {
+        if (i < a_size && deleted[i]) {
+            i++;
+        } else if (j < b_size && inserted[j]) {
+            append_literal(ops, B[prefix + j++]);
+        } else {
+            append_copy(ops, offset(prefix + i), A[prefix + i].size());
+            i++;
+            j++;
+        }
+    }
+    if (suffix > 0) {
+        append_copy(ops, offset(A.size() - suffix), base.size() - offset(A.size() - suffix));
+    }
+    return ops;
+}
+
+#endif
@@ -0,0 +1,534 @@
+#ifndef DIFF_HPP
+#define DIFF_HPP
+
+#include "HashMap.hpp"
+#include "Myers.hpp"
+#include "Patience.hpp"
+#include "Histogram.hpp"
+#include "BitLcs.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include <stdexcept>
+#include <iostream>
+
+struct DiffLine {
+    // struct for line and status
+    char c;
+    std::string line;
+
+    DiffLine(int i, std::string_view line) {
+        if (i == 0) {
+            c = ' ';
+        } else if (i == 1) {
+            c = '+';
+        } else {
+            c = '-';
+        }
+        this->line = line;
+    }
+};
+
+enum class DiffAlgorithm {
+    Myers, // shortest edit script
+    Patience, // anchored on lines unique to both versions
+    Histogram // anchored on the rarest common lines
+};
+
+inline DiffAlgorithm parse_diff_algorithm(std::string_view name) {
+    // algorithm named by COMPARE's --algo option
+    if (name == "myers") {
+        return DiffAlgorithm::Myers;
+    }
+    if (name == "patience") {
+        return DiffAlgorithm::Patience;
+    }
+    if (name == "histogram") {
+        return DiffAlgorithm::Histogram;
+    }
+    throw std::invalid_argument("Unknown diff algorithm '" + std::string(name) +
+                                "', expected myers, patience or histogram.");
+}
+
+enum class InlineMode {
+    None, // changed lines printed whole
+    Chars, // changed characters highlighted
+    Words // changed words highlighted
+};
+
+inline InlineMode parse_inline_mode(std::string_view name) {
+    // granularity named by COMPARE's --inline option
+    if (name == "none") {
+        return InlineMode::None;
+    }
+    if (name == "chars") {
+        return InlineMode::Chars;
+    }
+    if (name == "words") {
+        return InlineMode::Words;
+    }
+    throw std::invalid_argument("Unknown inline mode '" + std::string(name) + "', expected none, chars or words.");
+}
+
+inline void split_lines(std::string_view text, std::vector<std::string_view> &lines) {
+    // appends the lines of text to lines the way std::getline reads them: split at '\n', without an empty line after
+    // a final '\n'. Newlines are found 16 bytes at a time and every line ending in the block is taken from one mask
+    const char *data = text.data();
+    size_t begin = 0;
+    size_t i = 0;
+#if HASHMAP_SSE2
+    const __m128i newline = _mm_set1_epi8('\n');
+    for (; i + 16 <= text.size(); i += 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        for (uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, newline))); mask != 0;
+             mask &= mask - 1) {
+            size_t end = i + std::countr_zero(mask);
+            lines.push_back(text.substr(begin, end - begin));
+            begin = end + 1;
+        }
+    }
+#endif
+    while (i < text.size()) {
+        const char *end = static_cast<const char *>(std::memchr(data + i, '\n', text.size() - i));
+        if (end == nullptr) {
+            break;
+        }
+        lines.push_back(text.substr(begin, end - data - begin));
+        begin = i = end - data + 1;
+    }
+    if (begin < text.size()) {
+        lines.push_back(text.substr(begin));
+    }
+}
+
+class LineIds {
+    // Interns lines as dense int IDs from 1. The table maps the hash of a line to the first ID with that hash; the
+    // rare distinct lines sharing a hash are chained through their IDs, and every match is confirmed on the text,
+    // so equal IDs always mean equal lines. Keying by the hash keeps slots small, which is what lookups pay for.
+private:
+    HashMap<uint64_t, int> first; // hash -> first ID with it
+    std::vector<std::string_view> lines; // line of every ID, index 0 unused
+    std::vector<int> next; // next ID with the same hash, 0 at the end
+
+public:
+    explicit LineIds(size_t expected) : first(static_cast<int>(std::min<size_t>(expected, INT32_MAX / 2))),
+                                        lines(1), next(1) {
+        // sized for expected lines
+        first.incremental_resize(false);
+    }
+
+    int size() const {
+        // distinct lines interned
+        return static_cast<int>(lines.size()) - 1;
+    }
+
+    int intern(std::string_view line) {
+        // ID of line, a new one if it has not been seen
+        return intern(line, hash_bytes(line.data(), line.size()));
+    }
+
+    int intern(std::string_view line, uint64_t hash) {
+        // ID of line, whose hash_bytes is given
+        int &head = first[hash];
+        for (int id = head; id != 0; id = next[id]) {
+            if (lines[id] == line) {
+                return id;
+            }
+        }
+        int id = static_cast<int>(lines.size());
+        lines.push_back(line);
+        next.push_back(head);
+        head = id;
+        return id;
+    }
+};
+
+inline void intern_lines(const std::string_view *A, size_t a_size, const std::string_view *B, size_t b_size,
+                         std::vector<int> &a_ids, std::vector<int> &b_ids, ThreadPool &pool) {
+    // interns the lines of A and B as dense IDs from 1 like one LineIds would, though not in the same order. Lines
+    // are hashed in parallel chunks, which also count the lines of every shard of hashes and then scatter their
+    // indices into one list per shard. Every thread interns the lines of its shard and the IDs of each shard are
+    // shifted past those of the shards before it, so no table is shared and each line is read by one shard
+    size_t total = a_size + b_size;
+    size_t shards = static_cast<size_t>(pool.size());
+    size_t chunks = shards * 4;
+    std::vector<uint64_t> hashes(total);
+    std::vector<uint32_t> order(total); // indices of the lines of every shard, shard by shard, ascending in each
+    std::vector<size_t> position(chunks * shards, 0); // lines of shard s in chunk c, then where they go in order
+    std::vector<size_t> shard_begin(shards + 1, 0); // where the lines of every shard start in order
+    auto line = [&](size_t k) { return k < a_size ? A[k] : B[k - a_size]; };
+    auto id = [&](size_t k) -> int & { return k < a_size ? a_ids[k] : b_ids[k - a_size]; };
+    auto shard = [&](size_t k) { return (hashes[k] >> 32) % shards; };
+    a_ids.resize(a_size);
+    b_ids.resize(b_size);
+    pool.parallel_for(chunks, [&](size_t c) {
+        for (size_t k = total * c / chunks; k < total * (c + 1) / chunks; k++) {
+            hashes[k] = hash_bytes(line(k).data(), line(k).size());
+            position[c * shards + shard(k)]++;
+        }
+    });
+    size_t next = 0;
+    for (size_t s = 0; s < shards; s++) {
+        shard_begin[s] = next;
+        for (size_t c = 0; c < chunks; c++) {
+            size_t count = position[c * shards + s];
+            position[c * shards + s] = next;
+            next += count;
+        }
+    }
+    shard_begin[shards] = next;
+    pool.parallel_for(chunks, [&](size_t c) {
+        for (size_t k = total * c / chunks; k < total * (c + 1) / chunks; k++) {
+            order[position[c * shards + shard(k)]++] = static_cast<uint32_t>(k);
+        }
+    });
+    std::vector<int> offset(shards + 1, 0); // IDs in the shards before every shard
+    pool.parallel_for(shards, [&](size_t s) {
+        LineIds ids(shard_begin[s + 1] - shard_begin[s]);
+        for (size_t o = shard_begin[s]; o < shard_begin[s + 1]; o++) {
+            id(order[o]) = ids.intern(line(order[o]), hashes[order[o]]);
+        }
+        offset[s + 1] = ids.size();
+    });
+    for (size_t s = 0; s < shards; s++) {
+        offset[s + 1] += offset[s];
+    }
+    pool.parallel_for(chunks, [&](size_t c) {
+        for (size_t k = total * c / chunks; k < total * (c + 1) / chunks; k++) {
+            id(k) += offset[shard(k)];
+        }
+    });
+}
+
+// changed middles with at least this many lines are interned and diffed on the thread pool
+constexpr size_t PARALLEL_DIFF_MIN_LINES = size_t(1) << 14;
+
+inline void mark_edits(const std::vector<int> &A, const std::vector<int> &B, std::vector<char> &deleted,
+                       std::vector<char> &inserted, DiffAlgorithm algorithm) {
+    // marks the lines of A deleted and of B inserted by the edit script the algorithm finds
+    switch (algorithm) {
+        case DiffAlgorithm::Patience:
+            PatienceDiff(A, B, deleted, inserted).compare();
+            break;
+        case DiffAlgorithm::Histogram:
+            HistogramDiff(A, B, deleted, inserted).compare();
+            break;
+        default:
+            MyersDiff<int>(A, B, deleted, inserted).compare();
+            break;
+    }
+}
+
+template<typename Engine>
+void mark_edits_split(const std::vector<int> &A, const std::vector<int> &B, std::vector<char> &deleted,
+                      std::vector<char> &inserted, DiffAlgorithm algorithm, ThreadPool &pool) {
+    // marks edits with a patience or histogram engine split into a few ranges per thread, the ranges then grouped
+    // into runs of about equal size, so uneven ranges even out, and compared on the pool with their IDs renumbered
+    // from 1. Each range writes its marks into a disjoint part of deleted and inserted
+    Engine engine(A, B, deleted, inserted);
+    std::vector<typename Engine::Range> ranges;
+    engine.split_until(static_cast<size_t>(pool.size()) * 4, ranges);
+    int ids = 0;
+    for (const std::vector<int> *lines: {&A, &B}) {
+        for (int id: *lines) {
+            ids = std::max(ids, id + 1);
+        }
+    }
+    size_t run_lines = (A.size() + B.size()) / (static_cast<size_t>(pool.size()) * 4) + 1;
+    std::vector<size_t> run_starts = {0}; // first range of every run
+    for (size_t k = 0, lines = 0; k < ranges.size(); k++) {
+        lines += ranges[k].a_end - ranges[k].a_begin + ranges[k].b_end - ranges[k].b_begin;
+        if (lines >= run_lines && k + 1 < ranges.size()) {
+            run_starts.push_back(k + 1);
+            lines = 0;
+        }
+    }
+    run_starts.push_back(ranges.size());
+
+    pool.parallel_for(run_starts.size() - 1, [&](size_t run) {
+        std::vector<int> local(ids, 0); // range-local ID of every ID, 0 if not yet seen in the range
+        std::vector<int> range_a, range_b;
+        std::vector<char> range_deleted, range_inserted;
+        for (size_t k = run_starts[run]; k < run_starts[run + 1]; k++) {
+            const typename Engine::Range &range = ranges[k];
+            int next_id = 1;
+            range_a.clear();
+            range_b.clear();
+            for (int i = range.a_begin; i < range.a_end; i++) {
+                range_a.push_back(local[A[i]] != 0 ? local[A[i]] : (local[A[i]] = next_id++));
+            }
+            for (int j = range.b_begin; j < range.b_end; j++) {
+                range_b.push_back(local[B[j]] != 0 ? local[B[j]] : (local[B[j]] = next_id++));
+            }
+            mark_edits(range_a, range_b, range_deleted, range_inserted, algorithm);
+            std::copy(range_deleted.begin(), range_deleted.end(), deleted.begin() + range.a_begin);
+            std::copy(range_inserted.begin(), range_inserted.end(), inserted.begin() + range.b_begin);
+            for (int i = range.a_begin; i < range.a_end; i++) {
+                local[A[i]] = 0;
+            }
+            for (int j = range.b_begin; j < range.b_end; j++) {
+                local[B[j]] = 0;
+            }
+        }
+    });
+}
+
+inline void mark_edits(const std::vector<int> &A, const std::vector<int> &B, std::vector<char> &deleted,
+                       std::vector<char> &inserted, DiffAlgorithm algorithm, ThreadPool &pool) {
+    // marks exactly the edits the sequential version does, on the pool: Myers solves the two sides of its middle
+    // snakes in parallel, patience and histogram the ranges their first splits leave. So the result does not
+    // depend on the number of threads, and Myers still finds a shortest script
+    switch (algorithm) {
+        case DiffAlgorithm::Patience:
+            mark_edits_split<PatienceDiff>(A, B, deleted, inserted, algorithm, pool);
+            break;
+        case DiffAlgorithm::Histogram:
+            mark_edits_split<HistogramDiff>(A, B, deleted, inserted, algorithm, pool);
+            break;
+        default:
+            MyersDiff<int>(A, B, deleted, inserted).compare(pool);
+            break;
+    }
+}
+
+struct LineSpan {
+    // bytes [begin, end) of a line
+    size_t begin;
+    size_t end;
+};
+
+// upper bound on the characters or words of one changed line times those of the other aligned by changed_spans
+constexpr size_t INLINE_DIFF_MAX_CELLS = size_t(1) << 30;
+
+inline void split_words(std::string_view line, std::vector<std::string_view> &words) {
+    // appends the words of line: runs of letters, digits, '_' and non-ASCII bytes, runs of whitespace, and every
+    // other character alone
+    auto word_byte = [](unsigned char c) { return std::isalnum(c) || c == '_' || c >= 0x80; };
+    for (size_t i = 0; i < line.size();) {
+        unsigned char c = line[i];
+        size_t end = i + 1;
+        if (word_byte(c)) {
+            while (end < line.size() && word_byte(line[end])) {
+                end++;
+            }
+        } else if (std::isspace(c)) {
+            while (end < line.size() && std::isspace(static_cast<unsigned char>(line[end]))) {
+                end++;
+            }
+        }
+        words.push_back(line.substr(i, end - i));
+        i = end;
+    }
+}
+
+inline void changed_spans(std::string_view from, std::string_view to, InlineMode mode,
+                          std::vector<LineSpan> &from_spans, std::vector<LineSpan> &to_spans) {
+    // bytes of from and to outside a longest common subsequence of their characters or words, found by the bit
+    // parallel LCS once their common ends are dropped. Left empty if less than half of the shorter line is common,
+    // as highlights then only add noise to lines that were rewritten, or if the changed middle exceeds
+    // INLINE_DIFF_MAX_CELLS
+    from_spans.clear();
+    to_spans.clear();
+    std::vector<int> a, b; // dense symbol of every character or word
+    std::vector<size_t> a_offsets, b_offsets; // byte offset of every word, then the length of the line
+    if (mode == InlineMode::Chars) {
+        int symbol[256];
+        std::fill(symbol, symbol + 256, -1);
+        int symbols = 0;
+        for (auto [line, out]: {std::pair{from, &a}, std::pair{to, &b}}) {
+            out->reserve(line.size());
+            for (unsigned char c: line) {
+                out->push_back(symbol[c] != -1 ? symbol[c] : (symbol[c] = symbols++));
+            }
+        }
+    } else if (mode == InlineMode::Words) {
+        LineIds ids(from.size() + to.size());
+        std::vector<std::string_view> words;
+        for (auto [line, out, offsets]: {std::tuple{from, &a, &a_offsets}, std::tuple{to, &b, &b_offsets}}) {
+            words.clear();
+            split_words(line, words);
+            for (std::string_view word: words) {
+                out->push_back(ids.intern(word));
+                offsets->push_back(word.data() - line.data());
+            }
+            offsets->push_back(line.size());
+        }
+    } else {
+        return;
+    }
+
+    size_t prefix = 0;
+    while (prefix < a.size() && prefix < b.size() && a[prefix] == b[prefix]) {
+        prefix++;
+    }
+    size_t suffix = 0;
+    while (suffix < a.size() - prefix && suffix < b.size() - prefix &&
+           a[a.size() - 1 - suffix] == b[b.size() - 1 - suffix]) {
+        suffix++;
+    }
+    if (prefix + suffix == a.size() && prefix + suffix == b.size()) {
+        return;
+    }
+    std::vector<int> a_middle(a.begin() + prefix, a.end() - suffix);
+    std::vector<int> b_middle(b.begin() + prefix, b.end() - suffix);
+    if (a_middle.size() * b_middle.size() > INLINE_DIFF_MAX_CELLS) {
+        return;
+    }
+    std::vector<char> deleted, inserted;
+    BitParallelLcs(a_middle, b_middle, deleted, inserted).compare();
+    size_t common = prefix + suffix + std::ranges::count(deleted, 0);
+    if (common * 2 < std::min(a.size(), b.size())) {
+        return;
+    }
+
+    for (auto [marks, offsets, spans]: {std::tuple{&deleted, &a_offsets, &from_spans},
+                                        std::tuple{&inserted, &b_offsets, &to_spans}}) {
+        for (size_t k = 0; k < marks->size(); k++) {
+            if (!(*marks)[k]) {
+                continue;
+            }
+            size_t begin = offsets->empty() ? prefix + k : (*offsets)[prefix + k];
+            size_t end = offsets->empty() ? prefix + k + 1 : (*offsets)[prefix + k + 1];
+            if (!spans->empty() && spans->back().end == begin) {
+                spans->back().end = end;
+            } else {
+                spans->push_back({begin, end});
+            }
+        }
+    }
+}
+
+inline std::vector<DiffLine> diff(const std::vector<std::string_view> &A, const std::vector<std::string_view> &B,
+                                  DiffAlgorithm algorithm = DiffAlgorithm::Myers, ThreadPool *pool = nullptr) {
+    // edit script from A to B, lines of each changed block deleted first, then inserted; the shortest one with
+    // Myers. Lines common to the start and the end are matched by comparing them directly; the lines in between
+    // are interned as dense ints, one per distinct line, so the engines compare ints instead of strings. Given a
+    // pool, a middle of at least PARALLEL_DIFF_MIN_LINES lines is interned and diffed on it, with the same result
+    size_t prefix = 0;
+    while (prefix < A.size() && prefix < B.size() && A[prefix] == B[prefix]) {
+        prefix++;
+    }
+    size_t suffix = 0;
+    while (suffix < A.size() - prefix && suffix < B.size() - prefix &&
+           A[A.size() - 1 - suffix] == B[B.size() - 1 - suffix]) {
+        suffix++;
+    }
+    size_t a_size = A.size() - prefix - suffix;
+    size_t b_size = B.size() - prefix - suffix;
+
+    std::vector<int> a_ids(a_size), b_ids(b_size);
+    bool parallel = pool != nullptr && a_size + b_size >= PARALLEL_DIFF_MIN_LINES;
+    if (parallel && a_size > 0 && b_size > 0) {
+        intern_lines(A.data() + prefix, a_size, B.data() + prefix, b_size, a_ids, b_ids, *pool);
+    } else if (a_size > 0 && b_size > 0) {
+        LineIds ids(a_size + b_size);
+        for (size_t i = 0; i < a_size; i++) {
+            a_ids[i] = ids.intern(A[prefix + i]);
+        }
+        for (size_t j = 0; j < b_size; j++) {
+            b_ids[j] = ids.intern(B[prefix + j]);
+        }
+    }
+    std::vector<char> deleted, inserted;
+    if (parallel) {
+        mark_edits(a_ids, b_ids, deleted, inserted, algorithm, *pool);
+    } else {
+        mark_edits(a_ids, b_ids, deleted, inserted, algorithm);
+    }
+
+    std::vector<DiffLine> difflines;
+    difflines.reserve(prefix + suffix + a_size + b_size);
+    for (size_t i = 0; i < prefix; i++) {
+        difflines.emplace_back(0, B[i]);
+    }
+    size_t i = 0;
+    size_t j = 0;
+    while (i < a_size || j < b_size) {
+        if (i < a_size && deleted[i]) {
+            difflines.emplace_back(2, A[prefix + i++]);
+        } else if (j < b_size && inserted[j]) {
+            difflines.emplace_back(1, B[prefix + j++]);
+        } else {
+            difflines.emplace_back(0, B[prefix + j]);
+            i++;
+            j++;
+        }
+    }
+    for (size_t k = B.size() - suffix; k < B.size(); k++) {
+        difflines.emplace_back(0, B[k]);
+    }
+    return difflines;
+}
+
+inline std::vector<DiffLine> diff(const std::vector<std::string> &A, const std::vector<std::string> &B,
+                                  DiffAlgorithm algorithm = DiffAlgorithm::Myers, ThreadPool *pool = nullptr) {
+    // edit script between lines held as strings
+    return diff(std::vector<std::string_view>(A.begin(), A.end()), std::vector<std::string_view>(B.begin(), B.end()),
+                algorithm, pool);
+}
+
+inline std::vector<DiffLine> diff(std::string_view A, std::string_view B,
+                                  DiffAlgorithm algorithm = DiffAlgorithm::Myers, ThreadPool *pool = nullptr) {
+    // edit script between the lines of two texts
+    std::vector<std::string_view> a_lines, b_lines;
+    split_lines(A, a_lines);
+    split_lines(B, b_lines);
+    return diff(a_lines, b_lines, algorithm, pool);
+}
+
+inline void print_diff_line(const DiffLine &l, const std::vector<LineSpan> &spans) {
+    // prints one line of a diff, its changed spans in reverse colors
+    const char *color = l.c == '+' ? "\033[1;32;47m" : l.c == '-' ? "\033[1;31;47m" : "\033[1;34;47m";
+    const char *changed = l.c == '+' ? "\033[1;37;42m" : "\033[1;37;41m";
+    std::cout << color << l.c << " ";
+    size_t printed = 0;
+    for (const LineSpan &span: spans) {
+        std::cout << std::string_view(l.line).substr(printed, span.begin - printed) << changed
+                << std::string_view(l.line).substr(span.begin, span.end - span.begin) << color;
+        printed = span.end;
+    }
+    std::cout << std::string_view(l.line).substr(printed) << "\n";
+}
+
+inline void printdiff(const std::string &A, const std::string &B, DiffAlgorithm algorithm = DiffAlgorithm::Myers,
+                      InlineMode inline_mode = InlineMode::None, ThreadPool *pool = nullptr) {
+    // prints diff from diffline array. Within each changed block, the k-th removed line and the k-th added line
+    // are refined with changed_spans when inline_mode asks for it
+    std::vector<DiffLine> outs = diff(std::string_view(A), std::string_view(B), algorithm, pool);
+    std::vector<std::vector<LineSpan> > spans; // changed spans of every line of the current block
+    for (size_t k = 0; k < outs.size();) {
+        size_t removed_end = k;
+        while (removed_end < outs.size() && outs[removed_end].c == '-') {
+            removed_end++;
+        }
+        size_t added_end = removed_end;
+        while (added_end < outs.size() && outs[added_end].c == '+') {
+            added_end++;
+        }
+        if (added_end == k) {
+            print_diff_line(outs[k++], {});
+            continue;
+        }
+        spans.assign(added_end - k, {});
+        size_t pairs = inline_mode == InlineMode::None ? 0 : std::min(removed_end - k, added_end - removed_end);
+        for (size_t p = 0; p < pairs; p++) {
+            changed_spans(outs[k + p].line, outs[removed_end + p].line, inline_mode, spans[p],
+                          spans[removed_end - k + p]);
+        }
+        for (size_t l = k; l < added_end; l++) {
+            print_diff_line(outs[l], spans[l - k]);
+        }
+        k = added_end;
+    }
+    std::cout << "\033[0m" << "\n";
+}
+
+#endif
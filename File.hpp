@@ -1,15 +1,17 @@
 #ifndef FILE_HPP
 #define FILE_HPP
 
-#include "TreeNode.hpp"
-#include "HashMap.hpp"
-#include "Myers.hpp"
+#include "VersionTable.hpp"
+#include "BlobStore.hpp"
+#include "Diff.hpp"
+#include "Delta.hpp"
 #include <string>
 #include <vector>
 #include <ctime>
 #include <stdexcept>
 #include <iostream>
 #include <iomanip>
+#include <ranges>
 
 inline std::string timeToString(time_t t) {
     // function to convert epoch time to DD/MM/YY HH:MM:SS
@@ -20,78 +22,188 @@ inline std::string timeToString(time_t t) {
     return oss.str();
 }
 
+enum class StorageMode {
+    Full, // versions share their parent's pieces where appended to, replaced contents are stored whole
+    Delta // replaced contents are also stored as slices of the parent's pieces, compacted every keyframe_interval versions
+};
+
 struct File {
-    TreeNode *root;
-    TreeNode *active_version;
-    HashMap<int, TreeNode *> version_map;
+    VersionTable versions; // every version, indexed by versionID
+    int active_version; // versionID of active version
     int total_versions;
     std::string name;
+    int id = -1; // interned ID, dense in creation order, assigned by the file system
     time_t last_modification_time;
+    StorageMode mode;
+    int keyframe_interval;
+    BlobStore *store; // shared store holding version contents
 
-    File(const std::string &filename, const std::string &content) {
+    File(const std::string &filename, const std::string &content, BlobStore &store,
+         StorageMode mode = StorageMode::Full, int keyframe_interval = 16, time_t timestamp = time(nullptr)) {
         name = filename;
-        root = new TreeNode(content, 0);
+        this->mode = mode;
+        this->keyframe_interval = keyframe_interval;
+        this->store = &store;
+        active_version = versions.add(Rope(store, content), -1, false, timestamp);
         total_versions = 1;
-        active_version = root;
-        version_map.insert(0, root);
-        snapshot("Initial Snapshot");
-        last_modification_time = root->created_timestamp;
+        snapshot("Initial Snapshot", timestamp);
+        last_modification_time = versions.created_timestamp[0];
+    }
+
+    File(const std::string &filename, BlobStore &store, StorageMode mode, int keyframe_interval) {
+        // file without versions, filled in when a checkpoint is loaded
+        name = filename;
+        this->mode = mode;
+        this->keyframe_interval = keyframe_interval;
+        this->store = &store;
+        active_version = 0;
+        total_versions = 0;
+        last_modification_time = 0;
     }
 
-    void snapshot(const std::string &message) {
+    void snapshot(const std::string &message, time_t timestamp = time(nullptr)) {
         // takes snapshot of current version
-        if (active_version->isSnapshot()) {
+        if (versions.isSnapshot(active_version)) {
             throw std::invalid_argument("Current version is already a snapshot");
         }
-        active_version->snapshot_timestamp = time(nullptr);
-        active_version->message = message;
+        versions.set_snapshot(active_version, message, timestamp);
+        if (versions.isSnapshot(active_version)) {
+            encode(active_version); // an empty message leaves the version mutable, so there is nothing to encode
+        }
+    }
+
+    void encode(int v) {
+        // stores a snapshotted version as a delta against its parent, or compacts it if a keyframe is due
+        int parent = versions.parent[v];
+        if (mode != StorageMode::Delta || parent == -1) {
+            return;
+        }
+        int chain_length = versions.chain_length[parent] + 1;
+        if (chain_length >= keyframe_interval) {
+            versions.content[v] = versions.content[v].compact();
+            versions.chain_length[v] = 0;
+            return;
+        }
+        versions.chain_length[v] = chain_length;
+        if (!(versions.rewritten[v])) {
+            return; // appended content already shares the parent's pieces
+        }
+        const Rope &base = versions.content[parent];
+        Rope delta(*store, "");
+        size_t copied = 0;
+        for (const DeltaOp &op: encode_delta(base.str(), versions.content[v].str())) {
+            if (op.copy) {
+                delta = delta + base.slice(op.offset, op.length);
+                copied += op.length;
+            } else {
+                delta = delta + Rope(*store, op.literal);
+            }
+        }
+        if (copied > 0) {
+            versions.content[v] = delta;
+        }
+    }
+
+    void append(int v, const std::string &content) {
+        // appends to a version that is not a snapshot in O(content + log pieces)
+        if (versions.isSnapshot(v)) {
+            throw std::invalid_argument("Snapshot content is immutable.");
+        }
+        versions.content[v] = versions.content[v] + Rope(*store, content);
     }
 
-    void newversion(const std::string &content, TreeNode *parent, int version_id) {
+    void write(int v, const std::string &content) {
+        // replaces content of a version that is not a snapshot
+        if (versions.isSnapshot(v)) {
+            throw std::invalid_argument("Snapshot content is immutable.");
+        }
+        versions.content[v] = Rope(*store, content);
+        versions.rewritten[v] = 1;
+    }
+
+    void newversion(const Rope &content, int parent, int version_id, bool rewritten = false,
+                    time_t timestamp = time(nullptr)) {
         // creates new version with given id and parent
-        if (version_map.count(version_id)) {
+        if (has_version(version_id)) {
             throw std::invalid_argument("Version ID must be unique.");
         }
-        TreeNode *new_version = new TreeNode(content, version_id);
+        if (version_id != total_versions) {
+            throw std::invalid_argument("Version IDs must be assigned in order.");
+        }
+        active_version = versions.add(content, parent, rewritten, timestamp);
         total_versions++;
-        new_version->parent = parent;
-        parent->children.push_back(new_version);
-        version_map.insert(version_id, new_version);
-        active_version = new_version;
-        last_modification_time = active_version->created_timestamp;
+        last_modification_time = versions.created_timestamp[active_version];
     }
 
-    void compare(int v1, int v2) const {
-        // prints diff between two versions
-        if (!(version_map.count(v1)) || !(version_map.count(v2))) {
+    bool has_version(int version_id) const {
+        // if version_id names an existing version
+        return version_id >= 0 && version_id < total_versions;
+    }
+
+    const Rope &content(int version_id) const {
+        // returns content of version with given id in O(1)
+        if (!(has_version(version_id))) {
             throw std::out_of_range("File doesn't have given versionID.");
         }
+        return versions.content[version_id];
+    }
+
+    bool isSnapshot(int version_id) const {
+        // if version with given id is a snapshot
+        return versions.isSnapshot(version_id);
+    }
+
+    int parent(int version_id) const {
+        // parent versionID, -1 for root
+        return versions.parent[version_id];
+    }
+
+    void compare(int v1, int v2, DiffAlgorithm algorithm = DiffAlgorithm::Myers,
+                 InlineMode inline_mode = InlineMode::None, ThreadPool *pool = nullptr) const {
+        // prints diff between two versions, large ones split across pool if given
+        const Rope &from = content(v1);
+        const Rope &to = content(v2);
         std::cout << "Comparing v" << v1 << " -> v" << v2 << "\n";
-        printdiff(version_map.get(v1)->content, version_map.get(v2)->content);
+        printdiff(from.str(), to.str(), algorithm, inline_mode, pool);
     }
 
     void print_details() const {
         // prints details of file
-        std::cout << "Active Version Size (in chars) : " << active_version->content.size() << "\n";
+        std::cout << "Active Version Size (in chars) : " << versions.content[active_version].size() << "\n";
         std::cout << "Total Version : " << total_versions << "\n";
         std::cout << "Last Modified Time : " << timeToString(last_modification_time) << "\n";
-        std::cout << "Active VersionID : " << active_version->version_id << "\n";
-        std::cout << "Active Version Creation Time : " << timeToString(active_version->created_timestamp) << "\n";
-        std::cout << "Active Version is " << (active_version->isSnapshot() ? "" : "not ") << "a snapshot.\n";
-        (active_version->version_id == 0)
+        std::cout << "Active VersionID : " << active_version << "\n";
+        std::cout << "Active Version Creation Time : " << timeToString(versions.created_timestamp[active_version])
+                << "\n";
+        std::cout << "Active Version is " << (versions.isSnapshot(active_version) ? "" : "not ") << "a snapshot.\n";
+        (active_version == 0)
             ? std::cout << "Active Version is root.\n"
-            : std::cout << "Parent of Active Version is v" << active_version->parent->version_id << "\n";
+            : std::cout << "Parent of Active Version is v" << versions.parent[active_version] << "\n";
+    }
+
+    void print_history(int limit = -1) const {
+        // prints up to limit snapshots on the path from the active version to the root, oldest first, in
+        // O(snapshots printed) by following snapshot ancestor links. A negative limit prints all of them
+        std::vector<int> snapshots;
+        for (int snap = versions.snapshot_at_or_above(active_version); snap != -1 && limit != 0;
+             snap = versions.snapshot_ancestor[snap]) {
+            snapshots.push_back(snap);
+            limit--;
+        }
+        for (int snap: std::ranges::reverse_view(snapshots)) {
+            std::cout << "VersionID : " << snap << " TimeStamp : " << timeToString(versions.snapshot_timestamp[snap])
+                    << " Message : " << versions.message(snap) << "\n";
+        }
     }
 
     void print_versions() const {
-        // prints all versions of file sorted by versionID
+        // prints all versions of file sorted by versionID, streaming through the metadata arrays
         for (int i = 0; i < total_versions; i++) {
-            TreeNode *current_v = version_map.get(i);
-            std::cout << "v" << i << (current_v->isSnapshot() ? " is a snapshot" : "") << (
-                (i == active_version->version_id) ? " is active " : " ");
-            (current_v->version_id == 0)
+            std::cout << "v" << i << (versions.snapshot[i] ? " is a snapshot" : "") << (
+                (i == active_version) ? " is active " : " ");
+            (i == 0)
                 ? std::cout << "is root.\n"
-                : std::cout << "with parent v" << current_v->parent->version_id << "\n";
+                : std::cout << "with parent v" << versions.parent[i] << "\n";
         }
     }
 };
@@ -2,212 +2,639 @@
 #define FILESYSTEM_HPP
 
 #include "File.hpp"
-#include "Heap.hpp"
-#include <ranges>
+#include "RecencyList.hpp"
+#include "CountBuckets.hpp"
+#include "SkipList.hpp"
+#include "ConcurrentHashMap.hpp"
+#include "Arena.hpp"
+#include "Memory.hpp"
+#include "Journal.hpp"
+#include "Checkpoint.hpp"
 #include <vector>
+#include <algorithm>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <stdexcept>
 #include <ctime>
 #include <iostream>
+#include <iomanip>
 
 
 class FileSystem {
 private:
-    HashMap<std::string, File *> files;
-    IndexedHeap<std::string, time_t, greater<time_t> > recent_files;
-    IndexedHeap<std::string, int, greater<int> > biggest_trees;
+    std::unique_ptr<MappedFile> image; // checkpoint this file system was loaded from, outlives the blobs viewing it
+    BlobStore store; // contents of every version, deduplicated across files
+    Pool<File> file_pool; // owns every file
+    ConcurrentHashMap<std::string, File *> files; // interns names, safe to look up from several threads
+    std::vector<File *> files_by_id; // every file at its interned ID
+    RecencyList recent_files; // file IDs, most recently modified first
+    SkipList<time_t> modified_files; // file IDs by last modification time, for time range queries
+    CountBuckets biggest_trees; // file IDs by total versions
+    StorageMode mode; // storage mode of newly created files
+    int keyframe_interval;
+    Journal *journal = nullptr; // receives every mutation if attached
+    time_t fixed_time = -1; // time used instead of the clock while replaying, -1 if unset
+    int checkpoint_id = 0; // ID of the last checkpoint loaded or written, 0 if none
+    int journal_checkpoint = 0; // checkpoint the replayed journal continues, 0 if none
+    std::unique_ptr<ThreadPool> diff_pool = std::make_unique<ThreadPool>(1); // threads COMPARE diffs large versions on
+
+    time_t now() const {
+        // current time of the file system
+        return fixed_time != -1 ? fixed_time : time(nullptr);
+    }
+
+    void log(JournalOp op, time_t timestamp, const File *file, const std::string &text = "",
+             int version_id = -1) const {
+        // appends a mutation to the journal if one is attached, naming the file by ID except when it is created
+        if (journal != nullptr) {
+            journal->append({op, timestamp, op == JournalOp::Create ? file->name : "", text, version_id, file->id});
+        }
+    }
+
+    const std::string &name_of(int id) const {
+        // name of the file with the given ID
+        if (id < 0 || static_cast<size_t>(id) >= files_by_id.size()) {
+            throw std::out_of_range("No file exists with given ID.");
+        }
+        return files_by_id[id]->name;
+    }
+
+    static int save_node(const RopeNode *node, HashMap<const RopeNode *, int, PointerHasher> &node_index,
+                         HashMap<const Blob *, int, PointerHasher> &blob_index, std::vector<ImageNode> &nodes,
+                         std::vector<Blob *> &blobs) {
+        // numbers node and its subtree in post order, each shared node once, and returns its index
+        if (node == nullptr) {
+            return -1;
+        }
+        if (node_index.count(node)) {
+            return node_index.get(node);
+        }
+        ImageNode saved{-1, -1, -1, 0, node->offset, node->length};
+        if (node->blob != nullptr) {
+            if (!(blob_index.count(node->blob))) {
+                blob_index.insert(node->blob, static_cast<int>(blobs.size()));
+                blobs.push_back(node->blob);
+            }
+            saved.blob = blob_index.get(node->blob);
+        } else {
+            saved.left = save_node(node->left, node_index, blob_index, nodes, blobs);
+            saved.right = save_node(node->right, node_index, blob_index, nodes, blobs);
+        }
+        if (nodes.size() >= static_cast<size_t>(INT32_MAX)) {
+            throw std::length_error("Too many rope nodes for a checkpoint.");
+        }
+        node_index.insert(node, static_cast<int>(nodes.size()));
+        nodes.push_back(saved);
+        return static_cast<int>(nodes.size()) - 1;
+    }
 
     void update_recent_files(const File *file) {
-        // function to update recent_files heap given filename
-        recent_files.update(file->name, file->last_modification_time);
+        // moves file to the front of recent_files, which stays sorted since modification times only grow
+        recent_files.touch(file->id);
+        modified_files.update(file->id, file->last_modification_time);
     }
 
     void update_biggest_trees(const File *file) {
-        // function to update biggest_trees heap given filename
-        biggest_trees.update(file->name, file->total_versions);
+        // moves file to the bucket of its total versions, the next one up since a file grows a version at a time
+        biggest_trees.update(file->id, file->total_versions);
     }
 
 public:
-    void create(const std::string &filename) {
+    FileSystem(StorageMode mode = StorageMode::Full, int keyframe_interval = 16) {
+        // constructor
+        if (keyframe_interval < 1) {
+            throw std::invalid_argument("Keyframe interval must be positive.");
+        }
+        this->mode = mode;
+        this->keyframe_interval = keyframe_interval;
+    }
+
+    FileSystem(const FileSystem &) = delete;
+
+    FileSystem &operator=(const FileSystem &) = delete;
+
+    ~FileSystem() {
+        // destroys every file, releasing all versions and their contents
+        for (File *file: files_by_id) {
+            file_pool.destroy(file);
+        }
+    }
+
+    void attach_journal(Journal *journal) {
+        // records every following mutation in journal, nullptr detaches. A journal that does not continue the
+        // loaded checkpoint is already contained in it and is restarted from it
+        this->journal = journal;
+        if (journal != nullptr && checkpoint_id != journal_checkpoint) {
+            journal->restart(checkpoint_id);
+            journal_checkpoint = checkpoint_id;
+        }
+    }
+
+    void apply(const JournalRecord &record) {
+        // applies a journaled mutation with its original timestamp
+        fixed_time = record.timestamp;
+        try {
+            switch (record.op) {
+                case JournalOp::Create:
+                    if (static_cast<size_t>(record.file_id) != files_by_id.size()) {
+                        throw std::runtime_error("File '" + record.filename + "' was created with another ID.");
+                    }
+                    create(record.filename);
+                    break;
+                case JournalOp::Insert:
+                    insert(name_of(record.file_id), record.text);
+                    break;
+                case JournalOp::Update:
+                    update(name_of(record.file_id), record.text);
+                    break;
+                case JournalOp::Snapshot:
+                    snapshot(name_of(record.file_id), record.text);
+                    break;
+                case JournalOp::Rollback:
+                    rollback(name_of(record.file_id), record.version_id);
+                    break;
+                case JournalOp::RollbackParent:
+                    rollback(name_of(record.file_id));
+                    break;
+                default:
+                    throw std::invalid_argument("Unknown journal record.");
+            }
+        } catch (...) {
+            fixed_time = -1;
+            throw;
+        }
+        fixed_time = -1;
+    }
+
+    size_t replay(const std::vector<JournalRecord> &records) {
+        // silently re-applies journaled mutations without journaling them again, returns how many were applied.
+        // A journal continuing a checkpoint starts with a marker and is only replayed on top of that checkpoint
+        size_t first = 0;
+        if (!records.empty() && records[0].op == JournalOp::Checkpoint) {
+            if (records[0].version_id > checkpoint_id) {
+                throw std::runtime_error("Journal continues checkpoint " + std::to_string(records[0].version_id) +
+                                         ", which was not loaded.");
+            }
+            if (records[0].version_id < checkpoint_id) {
+                return 0; // written before the loaded checkpoint, which contains it
+            }
+            journal_checkpoint = checkpoint_id;
+            first = 1;
+        } else if (checkpoint_id != 0) {
+            return 0; // the process stopped between writing the checkpoint and restarting the journal
+        }
+        Journal *attached = journal;
+        journal = nullptr;
+        std::streambuf *console = std::cout.rdbuf(nullptr);
+        size_t applied = 0;
+        try {
+            for (size_t i = first; i < records.size(); i++) {
+                apply(records[i]);
+                store.maintain();
+                applied++;
+            }
+        } catch (const std::exception &e) {
+            std::cout.rdbuf(console);
+            journal = attached;
+            throw std::runtime_error("Journal replay failed at record " + std::to_string(first + applied + 1) + ": " +
+                                     e.what());
+        }
+        std::cout.rdbuf(console);
+        journal = attached;
+        return applied;
+    }
+
+    void enable_cold_store(const std::string &directory, size_t memory_budget) {
+        // keeps at most memory_budget bytes of version contents in memory after each maintain(), spilling the
+        // least recently used to directory and loading them back when READ, COMPARE or a diff needs them
+        store.enable_cold_store(directory, memory_budget);
+    }
+
+    void enable_compression(int commands) {
+        // LZ compresses version contents not read for the given number of commands, 0 turns it off
+        if (commands < 0) {
+            throw std::invalid_argument("Compression delay cannot be negative.");
+        }
+        store.enable_compression(commands);
+    }
+
+    void enable_parallel_diff(int threads) {
+        // diffs large versions on the given number of threads, counting the calling thread
+        if (threads < 1) {
+            throw std::invalid_argument("Diff threads must be at least 1.");
+        }
+        diff_pool = std::make_unique<ThreadPool>(threads);
+    }
+
+    void maintain() {
+        // compresses contents that went cold and evicts them down to the memory budget, to be called between
+        // commands since contents returned by read() may be compressed or evicted
+        store.maintain();
+    }
+
+    void checkpoint(const std::string &path) {
+        // writes a binary image of every file, version and heap to path and restarts the journal from it. Rope
+        // nodes shared between versions are written once, so the image is about as big as the file system in memory
+        HashMap<const RopeNode *, int, PointerHasher> node_index;
+        HashMap<const Blob *, int, PointerHasher> blob_index;
+        std::vector<ImageNode> nodes;
+        std::vector<Blob *> blobs;
+        std::vector<std::vector<int32_t> > roots; // rope node of every version of every file
+        for (const File *file: files_by_id) {
+            roots.emplace_back();
+            for (int v = 0; v < file->total_versions; v++) {
+                roots.back().push_back(save_node(file->versions.content[v].root_node(), node_index, blob_index,
+                                                 nodes, blobs));
+            }
+        }
+        int id = checkpoint_id + 1;
+
+        ImageWriter out(path);
+        out.put_bytes(CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+        out.put<uint32_t>(CHECKPOINT_BYTE_ORDER);
+        out.put<uint32_t>(sizeof(time_t));
+        out.put<int32_t>(id);
+        out.put<uint64_t>(blobs.size());
+        for (Blob *blob: blobs) {
+            out.put_bytes(blob->digest.data(), blob->digest.size());
+            out.put_string(store.fetch(blob));
+            store.maintain(); // the writer keeps its own copy, so blobs loaded for it can go again
+        }
+        out.put<uint64_t>(nodes.size());
+        out.put_array(nodes);
+        out.put<uint64_t>(files_by_id.size());
+        for (size_t i = 0; i < files_by_id.size(); i++) {
+            const File *file = files_by_id[i]; // in ID order, so loading hands out the same IDs
+            out.put_string(file->name);
+            out.put<int32_t>(file->active_version);
+            out.put<int32_t>(file->total_versions);
+            out.put<int64_t>(file->last_modification_time);
+            out.put<uint8_t>(static_cast<uint8_t>(file->mode));
+            out.put<int32_t>(file->keyframe_interval);
+            file->versions.save(out);
+            out.put_array(roots[i]);
+        }
+        out.put<uint64_t>(recent_files.size());
+        recent_files.for_each([&](int file_id) {
+            out.put<int32_t>(file_id);
+        });
+        out.put<uint64_t>(biggest_trees.size());
+        biggest_trees.for_each([&](int file_id, int) {
+            out.put<int32_t>(file_id); // the count is the file's total versions
+        });
+        out.put_bytes(CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+        out.commit();
+
+        checkpoint_id = id;
+        if (journal != nullptr) {
+            journal->restart(id);
+            journal_checkpoint = id;
+        }
+        std::cout << "Checkpoint " << id << " written to '" << path << "'.\n";
+    }
+
+    void load_checkpoint(const std::string &path) {
+        // restores an empty file system from a checkpoint image. The image is memory mapped and blob contents are
+        // served from it in place, new versions get their own blobs as usual
+        if (files.size() != 0) {
+            throw std::invalid_argument("Checkpoint can only be loaded into an empty file system.");
+        }
+        std::unique_ptr<MappedFile> mapped = std::make_unique<MappedFile>(path);
+        ImageReader in(mapped->data(), mapped->size());
+        std::vector<Blob *> blobs; // one reference each, held while the nodes are built
+        std::vector<Rope> nodes; // one reference to every saved node, held while the versions are built
+        int id;
+        try {
+            if (in.get_view(sizeof(CHECKPOINT_MAGIC)) != std::string_view(CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC))
+                || in.get<uint32_t>() != CHECKPOINT_BYTE_ORDER || in.get<uint32_t>() != sizeof(time_t)) {
+                throw std::runtime_error("'" + path + "' is not a checkpoint image written by this build.");
+            }
+            id = in.get<int32_t>();
+            uint64_t blob_count = in.get<uint64_t>();
+            for (uint64_t i = 0; i < blob_count; i++) {
+                std::string digest(in.get_view(32));
+                blobs.push_back(store.adopt(in.get_string(), digest));
+            }
+            uint64_t node_count = in.get<uint64_t>();
+            for (uint64_t i = 0; i < node_count; i++) {
+                ImageNode node = in.get<ImageNode>();
+                if (node.blob >= 0) {
+                    if (static_cast<size_t>(node.blob) >= blobs.size() || node.length == 0 ||
+                        node.offset > blobs[node.blob]->size ||
+                        node.length > blobs[node.blob]->size - node.offset) {
+                        throw std::runtime_error("Checkpoint image is truncated or corrupt.");
+                    }
+                    nodes.push_back(Rope::from_piece(store, blobs[node.blob], node.offset, node.length));
+                } else {
+                    if (node.left < 0 || node.right < 0 || static_cast<size_t>(node.left) >= nodes.size() ||
+                        static_cast<size_t>(node.right) >= nodes.size()) {
+                        throw std::runtime_error("Checkpoint image is truncated or corrupt.");
+                    }
+                    nodes.push_back(Rope::from_children(nodes[node.left], nodes[node.right]));
+                }
+            }
+            uint64_t file_count = in.get<uint64_t>();
+            for (uint64_t i = 0; i < file_count; i++) {
+                std::string name(in.get_string());
+                int active_version = in.get<int32_t>();
+                int total_versions = in.get<int32_t>();
+                time_t last_modification_time = static_cast<time_t>(in.get<int64_t>());
+                uint8_t saved_mode = in.get<uint8_t>();
+                int saved_keyframe_interval = in.get<int32_t>();
+                if (files.count(name) || total_versions < 1 || active_version < 0 ||
+                    active_version >= total_versions || saved_mode > static_cast<uint8_t>(StorageMode::Delta) ||
+                    saved_keyframe_interval < 1) {
+                    throw std::runtime_error("Checkpoint image is truncated or corrupt.");
+                }
+                File *file = file_pool.create(name, store, static_cast<StorageMode>(saved_mode),
+                                              saved_keyframe_interval);
+                file->id = static_cast<int>(files_by_id.size());
+                files_by_id.push_back(file);
+                files.insert(name, file);
+                file->active_version = active_version;
+                file->total_versions = total_versions;
+                file->last_modification_time = last_modification_time;
+                file->versions.load(in, total_versions);
+                for (int v = 0; v < total_versions; v++) {
+                    int root = in.get<int32_t>();
+                    if (root < -1 || root >= static_cast<int>(nodes.size())) {
+                        throw std::runtime_error("Checkpoint image is truncated or corrupt.");
+                    }
+                    file->versions.content.create(root == -1 ? Rope(store, "") : nodes[root]);
+                }
+            }
+            if (in.get<uint64_t>() != file_count) {
+                throw std::runtime_error("Checkpoint image is truncated or corrupt.");
+            }
+            std::vector<int> recent(file_count); // most recently modified first
+            for (int &file_id: recent) {
+                file_id = in.get<int32_t>();
+            }
+            if (in.get<uint64_t>() != file_count) {
+                throw std::runtime_error("Checkpoint image is truncated or corrupt.");
+            }
+            std::vector<int> biggest(file_count); // most versions first
+            for (int &file_id: biggest) {
+                file_id = in.get<int32_t>();
+            }
+            if (in.get_view(sizeof(CHECKPOINT_MAGIC)) != std::string_view(CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC))
+                || !in.done()) {
+                throw std::runtime_error("Checkpoint image is truncated or corrupt.");
+            }
+            for (size_t i = 0; i < file_count; i++) {
+                if (recent[i] < 0 || static_cast<uint64_t>(recent[i]) >= file_count || biggest[i] < 0 ||
+                    static_cast<uint64_t>(biggest[i]) >= file_count || recent_files.contains(recent[i]) ||
+                    biggest_trees.contains(biggest[i]) || (i > 0 && files_by_id[biggest[i]]->total_versions >
+                                                           files_by_id[biggest[i - 1]]->total_versions)) {
+                    throw std::runtime_error("Checkpoint image is truncated or corrupt.");
+                }
+                recent_files.push_back(recent[i]);
+                modified_files.insert(recent[i], files_by_id[recent[i]]->last_modification_time);
+                biggest_trees.insert(biggest[i], files_by_id[biggest[i]]->total_versions); // O(1) as the lowest
+            }
+        } catch (...) {
+            files.clear();
+            recent_files.clear();
+            modified_files.clear();
+            biggest_trees.clear();
+            for (File *file: files_by_id) {
+                file_pool.destroy(file);
+            }
+            files_by_id.clear();
+            nodes.clear();
+            for (Blob *blob: blobs) {
+                store.release(blob);
+            }
+            throw;
+        }
+        nodes.clear();
+        for (Blob *blob: blobs) {
+            store.release(blob);
+        }
+        image = std::move(mapped);
+        checkpoint_id = id;
+    }
+
+    int current_checkpoint() const {
+        // ID of the last checkpoint loaded or written, 0 if none
+        return checkpoint_id;
+    }
+
+    size_t file_count() const {
+        // number of files
+        return files.size();
+    }
+
+    void create(std::string_view filename) {
         // creates new file with given name
         if (files.count(filename)) {
             throw std::invalid_argument("Duplicate Filename not allowed.");
         }
-        File *newfile = new File(filename, "");
-        files.insert(filename, newfile);
-        recent_files.push(newfile->name, newfile->last_modification_time);
-        biggest_trees.push(newfile->name, newfile->total_versions);
+        time_t timestamp = now();
+        File *newfile = file_pool.create(std::string(filename), "", store, mode, keyframe_interval, timestamp);
+        newfile->id = static_cast<int>(files_by_id.size());
+        files.insert(newfile->name, newfile);
+        files_by_id.push_back(newfile);
+        recent_files.touch(newfile->id);
+        modified_files.insert(newfile->id, newfile->last_modification_time);
+        biggest_trees.insert(newfile->id, newfile->total_versions);
+        log(JournalOp::Create, timestamp, newfile);
         std::cout << "File '" << filename << "' created.\n";
     }
 
-    const std::string &read(const std::string &filename) const {
-        // prints content of active version of file
+    const Rope &read(std::string_view filename) const {
+        // returns content of active version of file, streamed piece by piece when printed
         if (!(files.count(filename))) {
             throw std::out_of_range("No file exists with given filename.");
         }
-        return files.get(filename)->active_version->content;
+        return files.get(filename)->content(files.get(filename)->active_version);
     }
 
-    void insert(const std::string &filename, const std::string &content) {
+    void insert(std::string_view filename, const std::string &content) {
         // inserts into active version of file if not snapshot, else creates new version and inserts
         if (!(files.count(filename))) {
             throw std::out_of_range("No file exists with given filename.");
         }
-        if (files.get(filename)->active_version->isSnapshot()) {
-            std::cout << "File '" << filename << "' current version v" << files.get(filename)->active_version->
-                    version_id << " is a snapshot.\n";
-            files.get(filename)->newversion(files.get(filename)->active_version->content + content,
-                                            files.get(filename)->active_version, files.get(filename)->total_versions);
-            update_biggest_trees(files.get(filename));
-            std::cout << "New version v" << files.get(filename)->active_version->version_id <<
-                    " created and content inserted into '" << filename << "' v" << files.get(filename)->active_version->
-                    version_id << ".\n";
+        File *file = files.get(filename);
+        time_t timestamp = now();
+        if (file->isSnapshot(file->active_version)) {
+            std::cout << "File '" << filename << "' current version v" << file->active_version << " is a snapshot.\n";
+            file->newversion(file->content(file->active_version) + Rope(store, content), file->active_version,
+                             file->total_versions, false, timestamp);
+            update_biggest_trees(file);
+            std::cout << "New version v" << file->active_version << " created and content inserted into '" << filename
+                    << "' v" << file->active_version << ".\n";
         } else {
-            files.get(filename)->active_version->content.append(content);
-            files.get(filename)->last_modification_time = time(nullptr);
-            std::cout << "Content inserted into '" << filename << "' v" << files.get(filename)->active_version->
-                    version_id << ".\n";
+            file->append(file->active_version, content);
+            file->last_modification_time = timestamp;
+            std::cout << "Content inserted into '" << filename << "' v" << file->active_version << ".\n";
         }
-        update_recent_files(files.get(filename));
+        update_recent_files(file);
+        log(JournalOp::Insert, timestamp, file, content);
     }
 
-    void update(const std::string &filename, const std::string &content) {
+    void update(std::string_view filename, const std::string &content) {
         // updates active version of file if not snapshot, else creates new version and updates
         if (!(files.count(filename))) {
             throw std::out_of_range("No file exists with given filename.");
         }
-        if (files.get(filename)->active_version->isSnapshot()) {
-            std::cout << "File '" << filename << "' current version v" << files.get(filename)->active_version->
-                    version_id << " is a snapshot.\n";
-            files.get(filename)->newversion(content, files.get(filename)->active_version,
-                                            files.get(filename)->total_versions);
-            update_biggest_trees(files.get(filename));
-            std::cout << "New version v" << files.get(filename)->active_version->version_id <<
-                    " created and content of '" << filename << "' v" << files.get(filename)->active_version->version_id
-                    << " updated.\n";
+        File *file = files.get(filename);
+        time_t timestamp = now();
+        if (file->isSnapshot(file->active_version)) {
+            std::cout << "File '" << filename << "' current version v" << file->active_version << " is a snapshot.\n";
+            file->newversion(Rope(store, content), file->active_version, file->total_versions, true, timestamp);
+            update_biggest_trees(file);
+            std::cout << "New version v" << file->active_version << " created and content of '" << filename << "' v"
+                    << file->active_version << " updated.\n";
         } else {
-            files.get(filename)->active_version->content = content;
-            files.get(filename)->last_modification_time = time(nullptr);
-            std::cout << "Content of '" << filename << "' v" << files.get(filename)->active_version->version_id <<
-                    " updated.\n";
+            file->write(file->active_version, content);
+            file->last_modification_time = timestamp;
+            std::cout << "Content of '" << filename << "' v" << file->active_version << " updated.\n";
         }
-        update_recent_files(files.get(filename));
+        update_recent_files(file);
+        log(JournalOp::Update, timestamp, file, content);
     }
 
-    void snapshot(const std::string &filename, const std::string &message) const {
+    void snapshot(std::string_view filename, const std::string &message) const {
         // snapshots current version if not a snapshot
         if (!(files.count(filename))) {
             throw std::out_of_range("No file exists with given filename.");
         }
-        files.get(filename)->snapshot(message);
-        std::cout << "Snapshot created for '" << filename << "' v" << files.get(filename)->active_version->version_id <<
-                ".\n";
+        File *file = files.get(filename);
+        time_t timestamp = now();
+        file->snapshot(message, timestamp);
+        log(JournalOp::Snapshot, timestamp, file, message);
+        std::cout << "Snapshot created for '" << filename << "' v" << file->active_version << ".\n";
     }
 
-    void rollback(const std::string &filename, int versionID) const {
+    void rollback(std::string_view filename, int versionID) const {
         // changes active version of file to given version
         if (!(files.count(filename))) {
             throw std::out_of_range("No file exists with given filename.");
         }
-        if (!(files.get(filename)->version_map.count(versionID))) {
+        File *file = files.get(filename);
+        if (!(file->has_version(versionID))) {
             throw std::out_of_range("File doesn't have given versionID.");
         }
-        std::cout << "Rolled back '" << filename << "' from v" << files.get(filename)->active_version->version_id << " to v" <<
+        std::cout << "Rolled back '" << filename << "' from v" << file->active_version << " to v" <<
                 versionID << ".\n";
-        files.get(filename)->active_version = files.get(filename)->version_map.get(versionID);
+        file->active_version = versionID;
+        log(JournalOp::Rollback, now(), file, "", versionID);
     }
 
-    void rollback(const std::string &filename) const {
+    void rollback(std::string_view filename) const {
         // changes active version of file to parent
         if (!(files.count(filename))) {
             throw std::out_of_range("No file exists with given filename.");
         }
         File *file = files.get(filename);
-        if (file->active_version->parent == nullptr) {
+        if (file->parent(file->active_version) == -1) {
             throw std::invalid_argument("Cannot rollback from root version");
         }
-        std::cout << "Rolled back '" << filename << "' from v" << files.get(filename)->active_version->version_id << " to parent v"
-                << file->active_version->parent->version_id << ".\n";
-        file->active_version = file->active_version->parent;
+        std::cout << "Rolled back '" << filename << "' from v" << file->active_version << " to parent v"
+                << file->parent(file->active_version) << ".\n";
+        file->active_version = file->parent(file->active_version);
+        log(JournalOp::RollbackParent, now(), file);
     }
 
-    void history(const std::string &filename) const {
+    void history(std::string_view filename) const {
         // shows snapshotted versions of the file in ascending order of created_timestamp, which lie on the path from active_node to the root in the file tree
         if (!(files.count(filename))) {
             throw std::out_of_range("No file exists with given filename.");
         }
         std::cout << "Snapshot History for File '" << filename << "'\n";
-        TreeNode *current = files.get(filename)->active_version;
-        std::vector<TreeNode *> snapshots;
-        while (current->parent != nullptr) {
-            if (current->isSnapshot()) {
-                snapshots.push_back(current);
-            }
-            current = current->parent;
+        files.get(filename)->print_history();
+    }
+
+    void history(std::string_view filename, int limit) const {
+        // shows the limit snapshotted versions closest to active_node on its path to the root, in ascending order of created_timestamp
+        if (!(files.count(filename))) {
+            throw std::out_of_range("No file exists with given filename.");
         }
-        snapshots.push_back(current);
-        for (TreeNode *&snap: std::ranges::reverse_view(snapshots)) {
-            std::cout << "VersionID : " << snap->version_id << " TimeStamp : " << timeToString(snap->snapshot_timestamp)
-                    <<
-                    " Message : " << snap->message << "\n";
+        if (limit < 0) {
+            throw std::invalid_argument("History limit cannot be negative.");
         }
+        std::cout << "Snapshot History for File '" << filename << "'\n";
+        files.get(filename)->print_history(limit);
     }
 
-    void compare(const std::string &filename, int v1, int v2 = -1) const {
+    void compare(std::string_view filename, int v1, int v2 = -1, DiffAlgorithm algorithm = DiffAlgorithm::Myers,
+                 InlineMode inline_mode = InlineMode::None) const {
         // prints diff of 2 file versions
         if (!(files.count(filename))) {
             throw std::out_of_range("No file exists with given filename.");
         }
         if (v2 == -1) {
-            files.get(filename)->compare(v1, files.get(filename)->active_version->version_id);
+            files.get(filename)->compare(v1, files.get(filename)->active_version, algorithm, inline_mode,
+                                         diff_pool.get());
         } else {
-            files.get(filename)->compare(v1, v2);
+            files.get(filename)->compare(v1, v2, algorithm, inline_mode, diff_pool.get());
         }
     }
 
     void print_recent_files(int num) {
-        // prints recent files sorted by last modified upto num elements
-        std::vector<Element<std::string, time_t> > tempv = recent_files.topk(num);
-        for (const Element<std::string, time_t> &elem: tempv) {
-            std::cout << "Filename : " << elem.key << ", Last Modified at : " << timeToString(elem.value)
-                    << "\n";
-        }
+        // prints recent files sorted by last modified upto num elements, most recently modified first on ties
+        recent_files.for_each([this](int file_id) {
+            const File *file = files_by_id[file_id];
+            std::cout << "Filename : " << file->name << ", Last Modified at : "
+                    << timeToString(file->last_modification_time) << "\n";
+        }, static_cast<size_t>(std::max(num, 0)));
     }
 
     void print_recent_files() {
         // prints recent files sorted by last modified
-        std::vector<Element<std::string, time_t> > tempv = {};
-        while (!(recent_files.empty())) {
-            Element<std::string, time_t> recent_file = recent_files.top();
-            tempv.push_back({recent_file});
-            recent_files.pop();
-            std::cout << "Filename : " << recent_file.key << ", Last Modified at : " << timeToString(recent_file.value)
-                    << "\n";
+        print_recent_files(static_cast<int>(recent_files.size()));
+    }
+
+    void print_modified(time_t from, time_t to, int limit, const SkipList<time_t>::Position &after) const {
+        // prints files last modified from from to to inclusive, oldest first, starting after the cursor after and
+        // listing at most limit of them, then the cursor for the next page if files are left. Costs O(log(N) + limit)
+        if (from > to) {
+            throw std::invalid_argument("MODIFIED range ends before it starts.");
+        }
+        if (limit < 0) {
+            throw std::invalid_argument("MODIFIED limit cannot be negative.");
+        }
+        SkipList<time_t>::Position cursor = after.value < from ? SkipList<time_t>::Position{from, -1} : after;
+        int file_id = modified_files.first_after(cursor);
+        for (; file_id != -1 && limit > 0; file_id = modified_files.next(file_id), limit--) {
+            const File *file = files_by_id[file_id];
+            if (file->last_modification_time > to) {
+                break;
+            }
+            std::cout << "Filename : " << file->name << ", Last Modified at : "
+                    << timeToString(file->last_modification_time) << "\n";
+            cursor = modified_files.position(file_id);
+        }
+        if (file_id != -1 && files_by_id[file_id]->last_modification_time <= to) {
+            std::cout << "Next page cursor : " << cursor.value << ":" << cursor.key << "\n";
         }
-        recent_files.build(tempv);
+    }
+
+    void print_modified(time_t from, time_t to, int limit) const {
+        // prints the first page of files last modified from from to to inclusive
+        print_modified(from, to, limit, {from, -1});
+    }
+
+    void print_modified(time_t from, time_t to) const {
+        // prints every file last modified from from to to inclusive, oldest first, streaming them without a copy
+        print_modified(from, to, static_cast<int>(files_by_id.size()), {from, -1});
     }
 
     void print_biggest_trees(int num) {
         // prints biggest trees sorted by total versions upto num elements
-        std::vector<Element<std::string, int> > tempv = biggest_trees.topk(num);
-        for (const Element<std::string, int> &elem: tempv) {
-            std::cout << "Filename : " << elem.key << ", Total Version : " << elem.value << "\n";
-        }
+        biggest_trees.for_each([this](int file_id, int total_versions) {
+            std::cout << "Filename : " << files_by_id[file_id]->name << ", Total Version : " << total_versions << "\n";
+        }, static_cast<size_t>(std::max(num, 0)));
     }
 
     void print_biggest_trees() {
         // prints biggest trees sorted by total versions
-        std::vector<Element<std::string, int> > tempv = {};
-        while (!(biggest_trees.empty())) {
-            Element<std::string, int> big_tree = biggest_trees.top();
-            tempv.push_back({big_tree});
-            biggest_trees.pop();
-            std::cout << "Filename : " << big_tree.key << ", Total Version : " << big_tree.value << "\n";
-        }
-        biggest_trees.build(tempv);
+        print_biggest_trees(static_cast<int>(biggest_trees.size()));
     }
 
-    void details(const std::string &filename) const {
+    void details(std::string_view filename) const {
         // prints details of file
         if (!(files.count(filename))) {
             throw std::out_of_range("No file exists with given filename.");
@@ -215,7 +642,37 @@ public:
         files.get(filename)->print_details();
     }
 
-    void versions(const std::string &filename) const {
+    void stats() const {
+        // prints storage statistics of the file system
+        std::cout << "Files : " << files.size() << "\n";
+        std::cout << "Unique Blobs : " << store.unique_blobs() << "\n";
+        std::cout << "Blob References : " << store.reference_count() << "\n";
+        std::cout << "Stored Bytes : " << store.bytes_stored() << "\n";
+        std::cout << "Mapped Bytes : " << store.bytes_mapped() << "\n";
+        std::cout << "Referenced Bytes : " << store.bytes_referenced() << "\n";
+        std::cout << "Rope Nodes : " << Rope::live_nodes() << "\n";
+        if (store.has_cold_store()) {
+            std::cout << "Resident Bytes : " << store.bytes_resident() << " (budget " << store.budget() << ")\n";
+            std::cout << "Cache Hits : " << store.cache_hits() << "\n";
+            std::cout << "Cache Misses : " << store.cache_misses() << "\n";
+            std::cout << "Cache Evictions : " << store.cache_evictions() << "\n";
+        } else if (store.has_compression()) {
+            std::cout << "Resident Bytes : " << store.bytes_resident() << "\n";
+        }
+        if (store.has_compression()) {
+            std::cout << "Compressed Blobs : " << store.compressed_count() << "\n";
+            std::cout << "Compression Ratio : " << std::fixed << std::setprecision(2) << store.compression_ratio()
+                    << std::defaultfloat << "\n";
+            std::cout << "Decompressions : " << store.decompression_count() << "\n";
+        }
+        if (resident_memory_bytes() != 0) {
+            std::cout << "Resident Memory (in KB) : " << resident_memory_bytes() / 1024 << "\n";
+        }
+        std::cout << "Dedup Ratio : " << std::fixed << std::setprecision(2) << store.dedup_ratio()
+                << std::defaultfloat << "\n";
+    }
+
+    void versions(std::string_view filename) const {
         // prints all versions of file sorted by versionid
         if (!(files.count(filename))) {
             throw std::out_of_range("No file exists with given filename.");
@@ -1,196 +1,562 @@
 #ifndef HASHMAP_HPP
 #define HASHMAP_HPP
 
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
 #include <iostream>
+#include <memory>
 #include <stdexcept>
 #include <string>
-#include <vector>
+#include <string_view>
+#include <type_traits>
 
-inline unsigned int djb2_hash(const std::string &str) {
-    // http://www.cse.yorku.ca/~oz/hash.html
-    unsigned long hash = 5381;
-    for (char c: str) {
-        hash = ((hash << 5) + hash) + c; // hash * 33 + c
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HASHMAP_SSE2 1
+#include <emmintrin.h>
+#endif
+
+// Word-at-a-time hashing after wyhash: input is read 8 or 16 bytes at a time and folded through 64x64->128 bit
+// multiplications, whose high and low halves are xored so every input bit reaches every output bit.
+constexpr uint64_t HASH_SECRET[4] = {
+    0xa0761d6478bd642full, 0xe7037ed1a0b428dbull, 0x8ebc6af09c88c6e3ull, 0x589965cc75374cc3ull
+};
+
+inline void hash_multiply(uint64_t &a, uint64_t &b) {
+    // replaces a and b with the low and high halves of their 128 bit product
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+    a = static_cast<uint64_t>(product);
+    b = static_cast<uint64_t>(product >> 64);
+#else
+    uint64_t a_hi = a >> 32, a_lo = static_cast<uint32_t>(a);
+    uint64_t b_hi = b >> 32, b_lo = static_cast<uint32_t>(b);
+    uint64_t lo_lo = a_lo * b_lo, hi_lo = a_hi * b_lo, lo_hi = a_lo * b_hi, hi_hi = a_hi * b_hi;
+    uint64_t cross = (lo_lo >> 32) + static_cast<uint32_t>(hi_lo) + lo_hi;
+    a = (cross << 32) | static_cast<uint32_t>(lo_lo);
+    b = hi_hi + (hi_lo >> 32) + (cross >> 32);
+#endif
+}
+
+inline uint64_t hash_mix(uint64_t a, uint64_t b) {
+    // 128 bit product of a and b folded to 64 bits
+    hash_multiply(a, b);
+    return a ^ b;
+}
+
+inline uint64_t hash_read64(const unsigned char *p) {
+    uint64_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+inline uint64_t hash_read32(const unsigned char *p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+inline uint64_t hash_bytes(const void *data, size_t length, uint64_t seed = 0) {
+    // hash of length bytes at data
+    const unsigned char *p = static_cast<const unsigned char *>(data);
+    seed ^= hash_mix(seed ^ HASH_SECRET[0], HASH_SECRET[1]);
+    uint64_t a, b;
+    if (length <= 16) {
+        if (length >= 4) {
+            // two possibly overlapping pairs of 4 byte reads cover the whole input
+            size_t shift = (length >> 3) << 2;
+            a = (hash_read32(p) << 32) | hash_read32(p + shift);
+            b = (hash_read32(p + length - 4) << 32) | hash_read32(p + length - 4 - shift);
+        } else if (length > 0) {
+            a = static_cast<uint64_t>(p[0]) << 16 | static_cast<uint64_t>(p[length >> 1]) << 8 | p[length - 1];
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        size_t i = length;
+        if (i > 48) {
+            // three independent lanes keep the multipliers busy on long inputs
+            uint64_t lane1 = seed, lane2 = seed;
+            do {
+                seed = hash_mix(hash_read64(p) ^ HASH_SECRET[1], hash_read64(p + 8) ^ seed);
+                lane1 = hash_mix(hash_read64(p + 16) ^ HASH_SECRET[2], hash_read64(p + 24) ^ lane1);
+                lane2 = hash_mix(hash_read64(p + 32) ^ HASH_SECRET[3], hash_read64(p + 40) ^ lane2);
+                p += 48;
+                i -= 48;
+            } while (i > 48);
+            seed ^= lane1 ^ lane2;
+        }
+        while (i > 16) {
+            seed = hash_mix(hash_read64(p) ^ HASH_SECRET[1], hash_read64(p + 8) ^ seed);
+            p += 16;
+            i -= 16;
+        }
+        a = hash_read64(p + i - 16);
+        b = hash_read64(p + i - 8);
     }
-    return hash;
+    a ^= HASH_SECRET[1];
+    b ^= seed;
+    hash_multiply(a, b);
+    return hash_mix(a ^ HASH_SECRET[0] ^ length, b ^ HASH_SECRET[1]);
+}
+
+inline uint64_t hash_int(uint64_t key) {
+    // integer mixing: consecutive or strided keys spread over all 64 bits
+    return hash_mix(key ^ HASH_SECRET[0], HASH_SECRET[1]);
 }
 
 template<typename K>
 struct CustomHasher {
-    // std::hash replacement for string and int keys.
-    unsigned int operator()(const K &key) const {
-        if constexpr (std::is_same_v<K, int>) {
-            return key;
-        } else if constexpr (std::is_same_v<K, std::string>) {
-            return djb2_hash(key);
+    // std::hash replacement for integer keys.
+    uint64_t operator()(const K &key) const {
+        if constexpr (std::is_integral_v<K>) {
+            return hash_int(static_cast<uint64_t>(key));
         } else {
-            throw std::invalid_argument("Custom Hash only supports int and std::string keys. Try using std::hash.");
+            throw std::invalid_argument("Custom Hash only supports integer and std::string keys. Try using std::hash.");
         }
     }
 };
 
-template<typename K, typename V>
-struct Bucket {
-    // Node element in Hashmap Array
-    K key;
-    V value;
-    Bucket *next;
+template<>
+struct CustomHasher<std::string> {
+    // std::hash replacement for string keys, transparent so a HashMap can be searched with a std::string_view
+    using is_transparent = void;
+
+    uint64_t operator()(std::string_view key) const {
+        return hash_bytes(key.data(), key.size());
+    }
+};
+
+template<>
+struct CustomHasher<std::string_view> {
+    // hashes views the same way as std::string keys, for tables of views into text owned elsewhere
+    uint64_t operator()(std::string_view key) const {
+        return hash_bytes(key.data(), key.size());
+    }
+};
+
+// Control byte of a slot: empty, deleted (a tombstone probes continue past) or full, in which case it holds the
+// low 7 bits of the key's hash. Empty and deleted have the sign bit set so one test finds both.
+constexpr int8_t CTRL_EMPTY = -128;
+constexpr int8_t CTRL_DELETED = -2;
+
+struct ControlGroup {
+    // GROUP_WIDTH consecutive control bytes, compared against a byte all at once. Every mask has one bit per
+    // matching slot, in slot order, so lane() of its lowest bit gives the slot offset within the group.
+#ifdef HASHMAP_SSE2
+    static constexpr size_t WIDTH = 16;
+    __m128i ctrl;
+
+    explicit ControlGroup(const int8_t *bytes) : ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i *>(bytes))) {
+    }
+
+    uint64_t match(int8_t byte) const {
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(byte))));
+    }
+
+    uint64_t match_empty() const {
+        return match(CTRL_EMPTY);
+    }
+
+    uint64_t match_free() const {
+        // empty or deleted
+        return static_cast<uint32_t>(_mm_movemask_epi8(ctrl));
+    }
+
+    static size_t lane(uint64_t mask) {
+        return std::countr_zero(mask);
+    }
+
+    static size_t lanes_after_last(uint64_t mask) {
+        return std::countl_zero(mask) - (64 - WIDTH);
+    }
+#else
+    // portable fallback: eight control bytes in a 64 bit word, one high bit per byte in the masks
+    static constexpr size_t WIDTH = 8;
+    static constexpr uint64_t LSBS = 0x0101010101010101ull;
+    static constexpr uint64_t MSBS = 0x8080808080808080ull;
+    uint64_t ctrl;
+
+    explicit ControlGroup(const int8_t *bytes) {
+        std::memcpy(&ctrl, bytes, sizeof(ctrl));
+        if constexpr (std::endian::native == std::endian::big) {
+            ctrl = std::byteswap(ctrl);
+        }
+    }
+
+    uint64_t match(int8_t byte) const {
+        // may report a false positive next to a true one, which the key comparison filters out
+        uint64_t x = ctrl ^ (LSBS * static_cast<uint8_t>(byte));
+        return (x - LSBS) & ~x & MSBS;
+    }
+
+    uint64_t match_empty() const {
+        // 0b10000000 is the only control byte with the high bit set and bit 1 clear
+        return ctrl & ~(ctrl << 6) & MSBS;
+    }
+
+    uint64_t match_free() const {
+        return ctrl & MSBS;
+    }
+
+    static size_t lane(uint64_t mask) {
+        return std::countr_zero(mask) >> 3;
+    }
 
-    Bucket(K k, V v) {
-        key = k;
-        value = v;
-        next = nullptr;
+    static size_t lanes_after_last(uint64_t mask) {
+        return std::countl_zero(mask) >> 3;
     }
+#endif
 };
 
 template<typename K, typename V, typename Hasher = CustomHasher<K> >
 class HashMap {
-    // Implementation of Hash Map
+    // Implementation of Hash Map: open addressing over a flat slot array in the style of a Swiss table. A parallel
+    // array of control bytes keeps 7 bits of each key's hash, so a probe filters a whole group of slots with a few
+    // instructions and compares keys only for slots whose byte matches.
+    // Growing is incremental: the full table is kept as the old generation and every later insert/remove moves
+    // MIGRATE_SLOTS of its slots into the new one, so no single operation pays for rehashing every key.
+    // A transparent Hasher (one defining is_transparent) lets count/get/remove take any key type it hashes, such
+    // as a std::string_view for std::string keys.
 private:
-    std::vector<Bucket<K, V> *> table; // stores buckets
-    int current_size;
-    const float threshold = 0.75; // threshold for doubling
+    struct Slot {
+        K key;
+        V value;
+    };
+
+    static constexpr size_t GROUP_WIDTH = ControlGroup::WIDTH;
+    static constexpr size_t NOT_FOUND = SIZE_MAX;
+    static constexpr size_t MIGRATE_SLOTS = 8;
+
+    struct Table {
+        // one generation of control bytes and slots
+        int8_t *ctrl = nullptr; // capacity + GROUP_WIDTH bytes, the last GROUP_WIDTH mirror the first
+        Slot *slots = nullptr; // constructed only where the control byte is full
+        size_t capacity = 0; // power of two, at least GROUP_WIDTH
+
+        void allocate(size_t new_capacity) {
+            // fresh arrays with every slot empty
+            capacity = new_capacity;
+            ctrl = new int8_t[capacity + GROUP_WIDTH];
+            std::memset(ctrl, CTRL_EMPTY, capacity + GROUP_WIDTH);
+            slots = std::allocator<Slot>().allocate(capacity);
+        }
+
+        void release() {
+            // frees the arrays, every slot must be empty or deleted
+            if (ctrl != nullptr) {
+                delete[] ctrl;
+                std::allocator<Slot>().deallocate(slots, capacity);
+            }
+            *this = Table();
+        }
+
+        void deallocate() {
+            // destroys the remaining keys and frees the arrays
+            for (size_t i = 0; i < capacity; i++) {
+                if (ctrl[i] >= 0) {
+                    slots[i].~Slot();
+                }
+            }
+            release();
+        }
+
+        void set_control(size_t i, int8_t byte) {
+            // keeps the mirrored tail in step so a group read near the end wraps around
+            ctrl[i] = byte;
+            if (i < GROUP_WIDTH) {
+                ctrl[capacity + i] = byte;
+            }
+        }
+
+        template<typename Q>
+        size_t find(const Q &key, uint64_t h) const {
+            // probes groups in triangular steps, which visits every group once when capacity is a power of two
+            size_t mask = capacity - 1;
+            size_t offset = (h >> 7) & mask;
+            for (size_t step = GROUP_WIDTH;; step += GROUP_WIDTH) {
+                ControlGroup group(ctrl + offset);
+                for (uint64_t match = group.match(control_of(h)); match != 0; match &= match - 1) {
+                    size_t i = (offset + ControlGroup::lane(match)) & mask;
+                    if (slots[i].key == key) {
+                        return i;
+                    }
+                }
+                if (group.match_empty() != 0) {
+                    return NOT_FOUND;
+                }
+                offset = (offset + step) & mask;
+            }
+        }
+
+        size_t find_free(uint64_t h) const {
+            // first empty or deleted slot on the probe sequence of h
+            size_t mask = capacity - 1;
+            size_t offset = (h >> 7) & mask;
+            for (size_t step = GROUP_WIDTH;; step += GROUP_WIDTH) {
+                uint64_t free = ControlGroup(ctrl + offset).match_free();
+                if (free != 0) {
+                    return (offset + ControlGroup::lane(free)) & mask;
+                }
+                offset = (offset + step) & mask;
+            }
+        }
+
+        bool erase(size_t i) {
+            // destroys slot i, returns true if it became empty rather than a tombstone
+            slots[i].~Slot();
+            // if every group window covering i has an empty slot, no probe ever went past i
+            size_t before = (i - GROUP_WIDTH) & (capacity - 1);
+            uint64_t empty_after = ControlGroup(ctrl + i).match_empty();
+            uint64_t empty_before = ControlGroup(ctrl + before).match_empty();
+            if (empty_before != 0 && empty_after != 0 &&
+                ControlGroup::lane(empty_after) + ControlGroup::lanes_after_last(empty_before) < GROUP_WIDTH) {
+                set_control(i, CTRL_EMPTY);
+                return true;
+            }
+            set_control(i, CTRL_DELETED);
+            return false;
+        }
+    };
+
+    Table table; // receives every new key
+    Table old; // generation being migrated into table, empty when no resize is in progress
+    size_t migrated = 0; // slots of old already moved
+    size_t current_size = 0; // keys in both generations
+    size_t growth_left = 0; // inserts into empty slots of table before it reaches its 7/8 load limit
+    bool incremental = true;
     Hasher hasher;
 
-    int hash(const K &key) const {
-        // gets index from key
-        return (hasher(key) % table.size() + table.size()) % table.size();
+    template<typename Q>
+    static constexpr bool lookup_key = !std::is_same_v<Q, K> && requires { typename Hasher::is_transparent; };
+
+    template<typename Q>
+    uint64_t hash(const Q &key) const {
+        // the low 7 bits go to the control byte and the rest pick the group, so the hasher must mix all of them
+        return hasher(key);
     }
 
-    void extend() {
-        // doubling trick
-        int oldc = table.size();
-        std::vector<Bucket<K, V> *> oldt = move(table);
-        table.assign(oldc * 2, nullptr);
-        current_size = 0;
-        for (int i = 0; i < oldc; i++) {
-            Bucket<K, V> *current = oldt[i];
-            while (current != nullptr) {
-                insert(current->key, current->value);
-                Bucket<K, V> *todel = current;
-                current = current->next;
-                delete todel;
+    static int8_t control_of(uint64_t h) {
+        return static_cast<int8_t>(h & 0x7F);
+    }
+
+    template<typename Q>
+    Slot *find(const Q &key, uint64_t h) const {
+        // slot holding key in either generation, nullptr if absent
+        size_t i = table.find(key, h);
+        if (i != NOT_FOUND) {
+            return &table.slots[i];
+        }
+        if (old.ctrl != nullptr && (i = old.find(key, h)) != NOT_FOUND) {
+            return &old.slots[i];
+        }
+        return nullptr;
+    }
+
+    void migrate(size_t count) {
+        // moves the keys of the next count old slots into table, and frees old once every slot was visited
+        if (old.ctrl == nullptr) {
+            return;
+        }
+        size_t end = std::min(old.capacity, migrated + count);
+        for (; migrated < end; migrated++) {
+            if (old.ctrl[migrated] < 0) {
+                continue;
+            }
+            uint64_t h = hash(old.slots[migrated].key);
+            size_t j = table.find_free(h);
+            new(&table.slots[j]) Slot(std::move(old.slots[migrated]));
+            if (table.ctrl[j] == CTRL_EMPTY) {
+                growth_left--;
+            }
+            table.set_control(j, control_of(h));
+            old.slots[migrated].~Slot();
+            old.set_control(migrated, CTRL_DELETED); // later probes of old must skip it
+        }
+        if (migrated == old.capacity) {
+            old.release();
+        }
+    }
+
+    void resize(size_t new_capacity) {
+        // makes the current arrays the old generation, moved over by the following operations
+        migrate(SIZE_MAX);
+        old = table;
+        migrated = 0;
+        table = Table();
+        table.allocate(new_capacity);
+        growth_left = new_capacity - new_capacity / 8;
+        if (!incremental) {
+            migrate(SIZE_MAX);
+        }
+    }
+
+    size_t claim(uint64_t h) {
+        // slot of table for a new key of hash h, resizing first if it would take the last empty slot allowed
+        size_t i = table.find_free(h);
+        if (table.ctrl[i] == CTRL_EMPTY && growth_left == 0) {
+            // mostly tombstones: rebuild at the same size, otherwise double
+            resize(current_size >= table.capacity * 7 / 16 ? table.capacity * 2 : table.capacity);
+            i = table.find_free(h);
+        }
+        return i;
+    }
+
+    void occupy(size_t i, uint64_t h) {
+        // marks slot i of table full once its key and value are constructed
+        if (table.ctrl[i] == CTRL_EMPTY) {
+            growth_left--;
+        }
+        table.set_control(i, control_of(h));
+        current_size++;
+    }
+
+    template<typename Q>
+    const V &value_of(const Q &key) const {
+        // value of key, which may be a K or any type a transparent Hasher accepts
+        Slot *slot = find(key, hash(key));
+        if (slot == nullptr) {
+            throw std::out_of_range("Error: Key not found in HashMap.");
+        }
+        return slot->value;
+    }
+
+    template<typename Q>
+    void erase(const Q &key) {
+        // removes key from whichever generation holds it
+        migrate(MIGRATE_SLOTS);
+        uint64_t h = hash(key);
+        size_t i = table.find(key, h);
+        if (i != NOT_FOUND) {
+            if (table.erase(i)) {
+                growth_left++;
             }
+            current_size--;
+        } else if (old.ctrl != nullptr && (i = old.find(key, h)) != NOT_FOUND) {
+            old.erase(i);
+            current_size--;
         }
     }
 
 public:
     HashMap(int capacity = 16) {
         // constructor
-        table.assign(capacity, nullptr);
-        current_size = 0;
+        table.allocate(std::bit_ceil(std::max(static_cast<size_t>(capacity > 0 ? capacity : 1), GROUP_WIDTH)));
+        growth_left = table.capacity - table.capacity / 8;
     }
 
+    HashMap(const HashMap &) = delete;
+
+    HashMap &operator=(const HashMap &) = delete;
+
     void clear() {
-        // deletes the hashmap
-        for (int i = 0; i < table.size(); i++) {
-            Bucket<K, V> *current = table[i];
-            while (current != nullptr) {
-                Bucket<K, V> *todel = current;
-                current = current->next;
-                delete todel;
-            }
-            table[i] = nullptr;
-        }
+        // deletes every key:value pair, keeping the capacity
+        old.deallocate();
+        size_t capacity = table.capacity;
+        table.deallocate();
+        table.allocate(capacity);
         current_size = 0;
+        growth_left = capacity - capacity / 8;
     }
 
     ~HashMap() {
         // destructor
-        clear();
+        old.deallocate();
+        table.deallocate();
+    }
+
+    void incremental_resize(bool enabled) {
+        // with incremental resizing off, a resize moves every key at once
+        incremental = enabled;
+        if (!incremental) {
+            migrate(SIZE_MAX);
+        }
+    }
+
+    size_t size() const {
+        // number of keys in hashmap
+        return current_size;
     }
 
     bool count(const K &key) const {
         // checks if key is present
-        Bucket<K, V> *current = table[hash(key)];
-        while (current != nullptr) {
-            if (current->key == key) {
-                return true;
-            }
-            current = current->next;
-        }
-        return false;
+        return find(key, hash(key)) != nullptr;
+    }
+
+    template<typename Q> requires lookup_key<Q>
+    bool count(const Q &key) const {
+        // checks if key is present without converting it to K
+        return find(key, hash(key)) != nullptr;
     }
 
     void insert(const K &key, const V &value) {
         // updates/ inserts value into key
-        if (current_size >= (table.size()) * threshold) {
-            extend();
-        }
-        int idx = hash(key);
-        Bucket<K, V> *current = table[idx];
-        while (current != nullptr) {
-            // update
-            if (current->key == key) {
-                current->value = value;
-                return;
-            }
-            current = current->next;
+        migrate(MIGRATE_SLOTS);
+        uint64_t h = hash(key);
+        if (Slot *slot = find(key, h)) {
+            slot->value = value;
+            return;
         }
-        Bucket<K, V> *newbucket = new Bucket<K, V>(key, value);
-        newbucket->next = table[idx];
-        table[idx] = newbucket; // insert
-        current_size++;
+        size_t i = claim(h);
+        new(&table.slots[i]) Slot{key, value};
+        occupy(i, h);
     }
 
     const V &get(const K &key) const {
         // returns value of key if found
-        Bucket<K, V> *current = table[hash(key)];
-        while (current != nullptr) {
-            if (current->key == key) {
-                return current->value;
-            }
-            current = current->next;
-        }
-        throw std::out_of_range("Error: Key not found in HashMap.");
+        return value_of(key);
+    }
+
+    template<typename Q> requires lookup_key<Q>
+    const V &get(const Q &key) const {
+        // returns value of key if found without converting it to K
+        return value_of(key);
     }
 
     void remove(const K &key) {
         // removes key:value from hashmap if present
-        int idx = hash(key);
-        Bucket<K, V> *current = table[idx];
-        if ((current != nullptr) && (current->key == key)) {
-            table[idx] = table[idx]->next;
-            delete current;
-            current_size--;
-            return;
-        }
-        while ((current != nullptr) && (current->next != nullptr)) {
-            if (current->next->key == key) {
-                Bucket<K, V> *todel = current->next;
-                current->next = current->next->next;
-                delete todel;
-                current_size--;
-                return;
+        erase(key);
+    }
+
+    template<typename Q> requires lookup_key<Q>
+    void remove(const Q &key) {
+        // removes key:value from hashmap if present without converting it to K
+        erase(key);
+    }
+
+    template<typename Visitor>
+    void for_each(Visitor visit) const {
+        // calls visit(key, value) for every key:value pair
+        for (const Table *generation: {&old, &table}) {
+            for (size_t i = 0; i < generation->capacity; i++) {
+                if (generation->ctrl[i] >= 0) {
+                    visit(generation->slots[i].key, generation->slots[i].value);
+                }
             }
-            current = current->next;
         }
     }
 
     void print() const {
         // prints all key:value pairs
-        for (int i = 0; i < table.size(); i++) {
-            if (table[i] != nullptr) {
-                Bucket<K, V> *current = table[i];
-                while (current != nullptr) {
-                    std::cout << current->key << " : " << current->value << "\n";
-                    current = current->next;
-                }
-            }
-        }
+        for_each([](const K &key, const V &value) {
+            std::cout << key << " : " << value << "\n";
+        });
     }
 
     V &operator[](const K &key) {
         // update or insert key, access value by key, if key not present, it creates a key with default value.
-        Bucket<K, V> *current = table[hash(key)];
-        while (current != nullptr) {
-            if (current->key == key) {
-                return current->value;
-            }
-            current = current->next;
+        migrate(MIGRATE_SLOTS);
+        uint64_t h = hash(key);
+        if (Slot *slot = find(key, h)) {
+            return slot->value;
         }
-        insert(key, V());
-        return table[hash(key)]->value;
+        size_t i = claim(h);
+        new(&table.slots[i]) Slot{key, V()};
+        occupy(i, h);
+        return table.slots[i].value;
     }
 };
 
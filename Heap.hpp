@@ -2,6 +2,7 @@
 #define HEAP_HPP
 
 #include "HashMap.hpp"
+#include <algorithm>
 #include <stdexcept>
 #include <vector>
 
@@ -36,77 +37,170 @@ struct Element {
     }
 };
 
-template<typename K, typename V, typename Compare>
-struct NestedElementComparator {
-    Compare comp;
+class DenseIndex {
+    // Index of an IndexedHeap whose keys are small non-negative ints, such as interned file IDs: a plain array from
+    // key to heap position, -1 where the key is absent, so keeping it up to date on a swap hashes nothing
+private:
+    std::vector<int> position;
+    size_t current_size = 0;
+
+public:
+    size_t size() const {
+        // number of keys present
+        return current_size;
+    }
+
+    bool count(int key) const {
+        // checks if key is present
+        return key >= 0 && static_cast<size_t>(key) < position.size() && position[key] != -1;
+    }
+
+    int get(int key) const {
+        // returns heap position of key if present
+        if (!(count(key))) {
+            throw std::out_of_range("Error: Key not found in DenseIndex.");
+        }
+        return position[key];
+    }
+
+    void insert(int key, int index) {
+        // updates/ inserts heap position of key
+        if (key < 0) {
+            throw std::invalid_argument("DenseIndex keys must be non-negative.");
+        }
+        if (static_cast<size_t>(key) >= position.size()) {
+            position.resize(std::max(static_cast<size_t>(key) + 1, position.size() * 2), -1);
+        }
+        current_size += position[key] == -1;
+        position[key] = index;
+    }
+
+    void remove(int key) {
+        // removes key if present
+        if (count(key)) {
+            position[key] = -1;
+            current_size--;
+        }
+    }
 
-    bool operator()(const Element<K, V> &lhs, const Element<K, V> &rhs) const {
-        return comp(lhs.value, rhs.value);
+    void clear() {
+        // removes every key, keeping the array
+        std::fill(position.begin(), position.end(), -1);
+        current_size = 0;
     }
 };
 
-template<typename K, typename V, typename Compare>
+template<typename K, typename V, typename Compare, typename Index = HashMap<K, int>, int Arity = 2>
 class IndexedHeap {
-    // Implementation of Indexed Heap
+    // Implementation of Indexed Heap. Every node has Arity children, so a 4- or 8-ary heap is shallower than a
+    // binary one and compares the children of a node within one or two cache lines on the way down
 private:
-    std::vector<Element<K, V> > heap; // ACBT array
-    HashMap<K, int> ind_map; // internal hashmap to get index of array by key
+    static_assert(Arity >= 2, "Heap arity must be at least 2.");
+
+    std::vector<Element<K, V> > heap; // complete Arity-ary tree array
+    Index ind_map; // internal index to get index of array by key, a HashMap unless the keys are dense ints
     Compare comp; // custom comparator
+    mutable std::vector<int> frontier; // scratch heap of array indices for topk, kept to reuse its allocation
 
     static int parent(int i) {
         // get index of parent of index i
-        return (i - 1) / 2;
+        return (i - 1) / Arity;
     }
 
-    int left(int i) {
-        // get index of left child of index i
-        return (2 * i + 1);
+    static int first_child(int i) {
+        // get index of first child of index i, the others follow it
+        return Arity * i + 1;
     }
 
-    int right(int i) {
-        // get index of right child of index i
-        return (2 * i + 2);
+    int count() const {
+        // number of elements as an index
+        return static_cast<int>(heap.size());
     }
 
-    void swap(int i, int j) {
-        // swaps elements in indices i and j
-        ind_map.insert(heap[i].key, j);
-        ind_map.insert(heap[j].key, i);
-        std::swap(heap[i], heap[j]);
+    void place(int i, Element<K, V> &&element) {
+        // moves element into index i and records it
+        heap[i] = std::move(element);
+        ind_map.insert(heap[i].key, i);
     }
 
     void sift_up(int i) {
-        // trickles up element to correct position
-        while (i > 0 && comp(heap[i].value, heap[parent(i)].value)) {
-            swap(i, parent(i));
+        // trickles up element to correct position, moving each parent it passes down by one level
+        Element<K, V> moving = std::move(heap[i]);
+        while (i > 0 && comp(moving.value, heap[parent(i)].value)) {
+            place(i, std::move(heap[parent(i)]));
             i = parent(i);
         }
+        place(i, std::move(moving));
     }
 
     void sift_down(int i) {
-        // trickles down element to correct position
-        while (i < heap.size()) {
-            int child;
-            if (left(i) >= heap.size() && right(i) >= heap.size()) {
-                break;
-            } else if (left(i) < heap.size() && right(i) < heap.size()) {
-                if (comp(heap[left(i)].value, heap[right(i)].value)) {
-                    child = left(i);
-                } else {
-                    child = right(i);
+        // trickles down element to correct position, moving the best child up by one level at each step
+        if (i >= count()) {
+            return;
+        }
+        Element<K, V> moving = std::move(heap[i]);
+        while (first_child(i) < count()) {
+            int best = first_child(i);
+            int last = std::min(best + Arity, count());
+            for (int child = best + 1; child < last; child++) {
+                if (comp(heap[child].value, heap[best].value)) {
+                    best = child;
                 }
-            } else if (left(i) < heap.size()) {
-                child = left(i);
-            } else if (right(i) < heap.size()) {
-                child = right(i);
             }
-            if (comp(heap[child].value, heap[i].value)) {
-                swap(i, child);
-                i = child;
-            } else {
+            if (!comp(heap[best].value, moving.value)) {
                 break;
             }
+            place(i, std::move(heap[best]));
+            i = best;
         }
+        place(i, std::move(moving));
+    }
+
+    void heapify() {
+        // restores heap order over the whole array in O(n)
+        for (int i = parent(count() - 1); count() > 1 && i >= 0; --i) {
+            sift_down(i);
+        }
+    }
+
+    bool frontier_before(int a, int b) const {
+        // checks if array index a is listed before b by topk
+        return comp(heap[a].value, heap[b].value);
+    }
+
+    void frontier_push(int index) const {
+        // adds an array index to the topk frontier
+        int i = static_cast<int>(frontier.size());
+        frontier.push_back(index);
+        while (i > 0 && frontier_before(index, frontier[(i - 1) / 2])) {
+            frontier[i] = frontier[(i - 1) / 2];
+            i = (i - 1) / 2;
+        }
+        frontier[i] = index;
+    }
+
+    int frontier_pop() const {
+        // removes and returns the best array index of the topk frontier
+        int top = frontier[0];
+        int moving = frontier.back();
+        frontier.pop_back();
+        int n = static_cast<int>(frontier.size());
+        int i = 0;
+        while (2 * i + 1 < n) {
+            int child = 2 * i + 1;
+            if (child + 1 < n && frontier_before(frontier[child + 1], frontier[child])) {
+                child++;
+            }
+            if (!frontier_before(frontier[child], moving)) {
+                break;
+            }
+            frontier[i] = frontier[child];
+            i = child;
+        }
+        if (n > 0) {
+            frontier[i] = moving;
+        }
+        return top;
     }
 
 public:
@@ -115,6 +209,11 @@ public:
         return heap.size();
     }
 
+    const std::vector<Element<K, V> > &elements() const {
+        // elements in heap order, so build() of a copy restores the heap without moving anything
+        return heap;
+    }
+
     bool empty() const {
         // if heap is empty
         return heap.empty();
@@ -136,9 +235,7 @@ public:
             throw std::invalid_argument("Key already exists in Heap.");
         }
         heap.push_back({key, value});
-        int i = heap.size() - 1;
-        ind_map.insert(key, i);
-        sift_up(i);
+        sift_up(count() - 1);
     }
 
     void pop() {
@@ -146,11 +243,14 @@ public:
         if (empty()) {
             throw std::out_of_range("Heap is empty.");
         }
-        K todel = heap[0].key;
-        swap(0, heap.size() - 1);
-        heap.pop_back();
-        ind_map.remove(todel);
-        sift_down(0);
+        ind_map.remove(heap[0].key);
+        if (count() > 1) {
+            heap[0] = std::move(heap.back());
+            heap.pop_back();
+            sift_down(0);
+        } else {
+            heap.pop_back();
+        }
     }
 
     const Element<K, V> &top() const {
@@ -180,46 +280,48 @@ public:
         // build heap from array of elements in O(n)
         heap = items;
         ind_map.clear();
-        for (int i = 0; i < heap.size(); i++) {
+        for (int i = 0; i < count(); i++) {
             ind_map.insert(heap[i].key, i);
         }
-        for (int i = parent(heap.size() - 1); i >= 0; --i) {
-            sift_down(i);
-        }
+        heapify();
     }
 
     void append(const std::vector<Element<K, V> > &items) {
         // append array of elements to heap in O(n)
-        for (int i = 0; i < items.size(); i++) {
-            ind_map.insert(items[i].key, i + size());
+        for (size_t i = 0; i < items.size(); i++) {
+            ind_map.insert(items[i].key, static_cast<int>(i + size()));
         }
         heap.insert(heap.end(), items.begin(), items.end());
-        for (int i = parent(heap.size() - 1); i >= 0; --i) {
-            sift_down(i);
-        }
+        heapify();
     }
 
-    std::vector<Element<K, V> > topk(int k) {
-        if (empty()) {
-            return {};
+    void topk(int k, std::vector<Element<K, V> > &out) const {
+        // replaces out with the k elements with the highest priority in order, leaving the heap as it is. Walks the
+        // array best first through a frontier of at most k * (Arity - 1) + 1 indices that keeps its capacity
+        // between calls, so nothing is allocated once out and the frontier have grown to k
+        out.clear();
+        k = std::min(k, count());
+        if (k <= 0) {
+            return;
         }
-        if (k > size()) {
-            k = size();
-        }
-        IndexedHeap<int, Element<K, V>, NestedElementComparator<K, V, Compare> > aux_heap;
-        std::vector<Element<K, V> > ret;
-        aux_heap.push(0, heap[0]);
+        out.reserve(k);
+        frontier.clear();
+        frontier.reserve(static_cast<size_t>(k) * (Arity - 1) + 1);
+        frontier.push_back(0);
         for (int i = 0; i < k; i++) {
-            ret.push_back(aux_heap.top().value);
-            int cur = aux_heap.top().key;
-            aux_heap.pop();
-            if (left(cur) < size()) {
-                aux_heap.push(left(cur), heap[left(cur)]);
-            }
-            if (right(cur) < size()) {
-                aux_heap.push(right(cur), heap[right(cur)]);
+            int cur = frontier_pop();
+            out.push_back(heap[cur]);
+            int last = std::min(first_child(cur) + Arity, count());
+            for (int child = first_child(cur); child < last; child++) {
+                frontier_push(child);
             }
         }
+    }
+
+    std::vector<Element<K, V> > topk(int k) const {
+        // returns the k elements with the highest priority in order
+        std::vector<Element<K, V> > ret;
+        topk(k, ret);
         return ret;
     }
 };
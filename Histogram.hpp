@@ -0,0 +1,153 @@
+#ifndef HISTOGRAM_HPP
+#define HISTOGRAM_HPP
+
+#include "Myers.hpp"
+#include <algorithm>
+#include <vector>
+
+class HistogramDiff {
+    // Histogram diff as in git (xhistogram.c) over interned line IDs. The occurrences of every line in the A range
+    // are counted and chained; B is scanned for the common region whose rarest line occurs least often in A, the
+    // longest one on ties, and the ranges on either side of it are diffed the same way. Unlike patience, lines need
+    // not be unique to anchor, so files made of a few distinct lines still split into small ranges, while lines
+    // occurring more than MAX_OCCURRENCES times are never used as anchors. A range with no usable line goes to Myers.
+public:
+    struct Range {
+        int a_begin;
+        int a_end;
+        int b_begin;
+        int b_end;
+    };
+
+private:
+    static constexpr int MAX_OCCURRENCES = 64;
+    static constexpr int NONE = -1;
+
+    const std::vector<int> &a;
+    const std::vector<int> &b;
+    std::vector<char> &deleted;
+    std::vector<char> &inserted;
+    MyersDiff<int> myers; // for ranges without usable lines
+    std::vector<int> a_count; // occurrences of every ID in the A range being diffed, zero between ranges
+    std::vector<int> a_first; // first occurrence of every ID in the A range
+    std::vector<int> a_next; // next occurrence of the same line, for every index of A
+    std::vector<Range> pending; // ranges still to diff
+
+    void split(const Range &range) {
+        // marks range if it is trivial, else queues the ranges around its best common region or hands it to Myers
+        int a_begin = range.a_begin, a_end = range.a_end, b_begin = range.b_begin, b_end = range.b_end;
+        while (a_begin < a_end && b_begin < b_end && a[a_begin] == b[b_begin]) {
+            a_begin++;
+            b_begin++;
+        }
+        while (a_begin < a_end && b_begin < b_end && a[a_end - 1] == b[b_end - 1]) {
+            a_end--;
+            b_end--;
+        }
+        if (a_begin == a_end) {
+            std::fill(inserted.begin() + b_begin, inserted.begin() + b_end, 1);
+            return;
+        }
+        if (b_begin == b_end) {
+            std::fill(deleted.begin() + a_begin, deleted.begin() + a_end, 1);
+            return;
+        }
+
+        for (int i = a_end - 1; i >= a_begin; i--) {
+            a_next[i] = a_count[a[i]] == 0 ? NONE : a_first[a[i]];
+            a_first[a[i]] = i;
+            a_count[a[i]]++;
+        }
+        Range best{};
+        int best_count = MAX_OCCURRENCES; // occurrences in A of the rarest line of the best region
+        bool found = false;
+        bool common = false; // whether any line is on both sides
+        for (int j = b_begin; j < b_end;) {
+            int count = a_count[b[j]];
+            int next_j = j + 1;
+            common = common || count > 0;
+            if (count > 0 && count <= best_count) {
+                for (int i = a_first[b[j]]; i != NONE; i = a_next[i]) {
+                    // grows the region around the pair (i, j) both ways while the lines match
+                    Range region{i, i + 1, j, j + 1};
+                    int rarest = count;
+                    while (region.a_begin > a_begin && region.b_begin > b_begin &&
+                           a[region.a_begin - 1] == b[region.b_begin - 1]) {
+                        region.a_begin--;
+                        region.b_begin--;
+                        rarest = std::min(rarest, a_count[a[region.a_begin]]);
+                    }
+                    while (region.a_end < a_end && region.b_end < b_end && a[region.a_end] == b[region.b_end]) {
+                        rarest = std::min(rarest, a_count[a[region.a_end]]);
+                        region.a_end++;
+                        region.b_end++;
+                    }
+                    next_j = std::max(next_j, region.b_end);
+                    if (!found || rarest < best_count || region.a_end - region.a_begin > best.a_end - best.a_begin) {
+                        best = region;
+                        best_count = rarest;
+                        found = true;
+                    }
+                }
+            }
+            j = next_j;
+        }
+        for (int i = a_begin; i < a_end; i++) {
+            a_count[a[i]] = 0;
+        }
+
+        if (found) {
+            pending.push_back({a_begin, best.a_begin, b_begin, best.b_begin});
+            pending.push_back({best.a_end, a_end, best.b_end, b_end});
+        } else if (common) {
+            myers.compare(a_begin, a_end, b_begin, b_end);
+        } else {
+            std::fill(deleted.begin() + a_begin, deleted.begin() + a_end, 1);
+            std::fill(inserted.begin() + b_begin, inserted.begin() + b_end, 1);
+        }
+    }
+
+public:
+    HistogramDiff(const std::vector<int> &A, const std::vector<int> &B, std::vector<char> &deleted,
+                  std::vector<char> &inserted) : a(A), b(B), deleted(deleted), inserted(inserted),
+                                                 myers(A, B, deleted, inserted), a_next(A.size()) {
+        // prepares to mark an edit script of A into B, whose IDs are small non-negative ints
+        int ids = 0;
+        for (const std::vector<int> *lines: {&A, &B}) {
+            for (int id: *lines) {
+                ids = std::max(ids, id + 1);
+            }
+        }
+        a_count.assign(ids, 0);
+        a_first.assign(ids, 0);
+    }
+
+    void split_until(size_t ranges, std::vector<Range> &unsolved) {
+        // splits level by level, marking the ranges that turn out trivial or go to Myers, until at least ranges
+        // are left or none is; those are handed to unsolved instead of being split further. Each depends only on
+        // its own lines, so comparing them apart, IDs renumbered or not, marks what compare() would
+        pending.assign(1, {0, static_cast<int>(a.size()), 0, static_cast<int>(b.size())});
+        std::vector<Range> level;
+        while (!(pending.empty()) && pending.size() < ranges) {
+            level.swap(pending);
+            pending.clear();
+            for (const Range &range: level) {
+                split(range);
+            }
+        }
+        unsolved.swap(pending);
+        pending.clear();
+    }
+
+    void compare() {
+        // marks deleted[i] and inserted[j] for every line of A and B outside the chosen common regions
+        pending.push_back({0, static_cast<int>(a.size()), 0, static_cast<int>(b.size())});
+        while (!(pending.empty())) {
+            Range range = pending.back();
+            pending.pop_back();
+            split(range);
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,387 @@
+#ifndef JOURNAL_HPP
+#define JOURNAL_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <chrono>
+#include <condition_variable>
+#include <ctime>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <filesystem>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <fcntl.h>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+enum class JournalOp : unsigned char {
+    Create = 1,
+    Insert = 2,
+    Update = 3,
+    Snapshot = 4,
+    Rollback = 5, // to version_id
+    RollbackParent = 6,
+    Checkpoint = 7 // first record of a journal continuing the checkpoint with ID version_id
+};
+
+enum class FsyncPolicy {
+    PerOp, // fsync after every record
+    Group, // buffer records and write + fsync them group_size at a time
+    Interval // write every record, fsync at most once per interval but no later than interval after a record
+};
+
+struct JournalRecord {
+    // one mutation of the file system
+    JournalOp op;
+    time_t timestamp; // time the mutation happened, reused when replaying
+    std::string filename; // name of a CREATE, empty for records naming the file by ID
+    std::string text; // content for INSERT/UPDATE, message for SNAPSHOT
+    int version_id; // target of ROLLBACK, checkpoint ID of a checkpoint marker
+    int file_id = -1; // interned ID of the file, the one a CREATE assigns
+};
+
+constexpr char JOURNAL_MAGIC[8] = {'C', 'G', 'F', 'S', 'J', 'N', 'L', '2'};
+
+inline uint32_t fnv1a(const char *data, size_t size) {
+    // 32 bit FNV-1a checksum
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+inline void replace_file(const std::string &from, const std::string &to) {
+    // atomically renames from over to, then makes the rename itself durable
+    std::filesystem::rename(from, to);
+#if !defined(_WIN32)
+    std::filesystem::path directory = std::filesystem::absolute(to).parent_path();
+    int fd = ::open(directory.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        ::fsync(fd);
+        ::close(fd);
+    }
+#endif
+}
+
+class Journal {
+    // Append-only binary journal of file system mutations, starting with JOURNAL_MAGIC.
+    // Record layout (little endian): u32 payload length, payload, u32 FNV-1a of payload, where payload is
+    // u8 op, i64 timestamp, i32 version_id, i32 file_id, u32 filename length, filename, u32 text length, text.
+    // Only CREATE carries the filename, every other record names its file by ID.
+    // Under FsyncPolicy::Interval a flusher thread fsyncs records left pending once the interval runs out, so
+    // they become durable even when no further record comes to do it; lock serializes it with the caller.
+private:
+    std::string path;
+    int fd;
+    FsyncPolicy policy;
+    int group_size;
+    std::chrono::milliseconds interval;
+    std::chrono::steady_clock::time_point last_sync;
+    std::string buffer; // encoded records not yet written
+    int pending_records = 0; // records written or buffered since the last fsync
+    size_t records_written = 0;
+    std::mutex lock; // guards the file and everything above against the flusher
+    std::condition_variable pending; // wakes the flusher when records are pending or it must stop
+    bool stopping = false;
+    std::thread flusher; // runs flush_pending under FsyncPolicy::Interval
+
+    static void put_u32(std::string &out, uint32_t value) {
+        for (int i = 0; i < 4; i++) {
+            out.push_back(static_cast<char>(value >> (8 * i)));
+        }
+    }
+
+    static void put_u64(std::string &out, uint64_t value) {
+        for (int i = 0; i < 8; i++) {
+            out.push_back(static_cast<char>(value >> (8 * i)));
+        }
+    }
+
+    static uint64_t get_le(const std::string &in, size_t pos, int bytes) {
+        uint64_t value = 0;
+        for (int i = 0; i < bytes; i++) {
+            value |= static_cast<uint64_t>(static_cast<unsigned char>(in[pos + i])) << (8 * i);
+        }
+        return value;
+    }
+
+    void write_buffer() {
+        // writes buffered records to the file
+        size_t done = 0;
+        while (done < buffer.size()) {
+#if defined(_WIN32)
+            int written = _write(fd, buffer.data() + done, static_cast<unsigned int>(buffer.size() - done));
+#else
+            ssize_t written = ::write(fd, buffer.data() + done, buffer.size() - done);
+#endif
+            if (written <= 0) {
+                throw std::runtime_error("Failed to write journal.");
+            }
+            done += static_cast<size_t>(written);
+        }
+        buffer.clear();
+    }
+
+    static int open_file(const std::string &path, bool truncate) {
+        // opens path for appending, creating it if needed
+#if defined(_WIN32)
+        int fd = _open(path.c_str(), _O_WRONLY | _O_CREAT | _O_APPEND | _O_BINARY | (truncate ? _O_TRUNC : 0), 0644);
+#else
+        int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | (truncate ? O_TRUNC : 0), 0644);
+#endif
+        if (fd < 0) {
+            throw std::runtime_error("Cannot open journal '" + path + "'.");
+        }
+        return fd;
+    }
+
+    static bool empty_file(int fd) {
+        // checks if nothing was written to fd yet
+#if defined(_WIN32)
+        return _lseeki64(fd, 0, SEEK_END) == 0;
+#else
+        return ::lseek(fd, 0, SEEK_END) == 0;
+#endif
+    }
+
+    static void close_file(int fd) {
+#if defined(_WIN32)
+        _close(fd);
+#else
+        ::close(fd);
+#endif
+    }
+
+    void fsync_file() {
+        // forces written records to stable storage
+#if defined(_WIN32)
+        int result = _commit(fd);
+#else
+        int result = ::fsync(fd);
+#endif
+        if (result != 0) {
+            throw std::runtime_error("Failed to fsync journal.");
+        }
+        pending_records = 0;
+        last_sync = std::chrono::steady_clock::now();
+    }
+
+    void flush_pending() {
+        // fsyncs the records pending when interval has passed since the last fsync, until the journal closes
+        std::unique_lock guard(lock);
+        while (true) {
+            pending.wait(guard, [&] { return stopping || pending_records > 0; });
+            if (pending.wait_until(guard, last_sync + interval, [&] { return stopping || pending_records == 0; })) {
+                if (stopping) {
+                    return;
+                }
+                continue; // append or sync got there first
+            }
+            try {
+                fsync_file();
+            } catch (const std::exception &e) {
+                std::fprintf(stderr, "Error: %s\n", e.what());
+                last_sync = std::chrono::steady_clock::now(); // retried an interval later
+            }
+        }
+    }
+
+public:
+    Journal(const std::string &path, FsyncPolicy policy = FsyncPolicy::PerOp, int group_size = 32,
+            int interval_ms = 100) {
+        // opens path for appending, creating it if needed
+        if (group_size < 1 || interval_ms < 0) {
+            throw std::invalid_argument("Journal group size must be positive and interval non-negative.");
+        }
+        fd = open_file(path, false);
+        if (empty_file(fd)) {
+            buffer.assign(JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC));
+            try {
+                write_buffer();
+            } catch (...) {
+                close_file(fd);
+                throw;
+            }
+        }
+        this->path = path;
+        this->policy = policy;
+        this->group_size = group_size;
+        interval = std::chrono::milliseconds(interval_ms);
+        last_sync = std::chrono::steady_clock::now();
+        if (policy == FsyncPolicy::Interval) {
+            flusher = std::thread(&Journal::flush_pending, this);
+        }
+    }
+
+    Journal(const Journal &) = delete;
+
+    Journal &operator=(const Journal &) = delete;
+
+    ~Journal() {
+        // makes every record durable before closing
+        if (flusher.joinable()) {
+            {
+                std::lock_guard guard(lock);
+                stopping = true;
+            }
+            pending.notify_one();
+            flusher.join();
+        }
+        try {
+            sync();
+        } catch (const std::exception &e) {
+            std::fprintf(stderr, "Error: %s\n", e.what());
+        }
+        close_file(fd);
+    }
+
+    static std::string encode(const JournalRecord &record) {
+        // serializes a record with its length prefix and checksum
+        std::string payload;
+        payload.push_back(static_cast<char>(record.op));
+        put_u64(payload, static_cast<uint64_t>(record.timestamp));
+        put_u32(payload, static_cast<uint32_t>(record.version_id));
+        put_u32(payload, static_cast<uint32_t>(record.file_id));
+        put_u32(payload, static_cast<uint32_t>(record.filename.size()));
+        payload += record.filename;
+        put_u32(payload, static_cast<uint32_t>(record.text.size()));
+        payload += record.text;
+        std::string out;
+        put_u32(out, static_cast<uint32_t>(payload.size()));
+        out += payload;
+        put_u32(out, fnv1a(payload.data(), payload.size()));
+        return out;
+    }
+
+    static std::vector<JournalRecord> load(const std::string &path) {
+        // reads every complete record of a journal. A torn or corrupt tail left by a crash is cut off so that
+        // new records are appended right after the last good one
+        std::vector<JournalRecord> records;
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            return records;
+        }
+        std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        in.close();
+        std::string_view magic(JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC));
+        if (data.size() < magic.size() && magic.starts_with(data)) {
+            std::filesystem::resize_file(path, 0); // the crash tore the header, nothing was journaled yet
+            return records;
+        }
+        if (!(std::string_view(data).starts_with(magic))) {
+            throw std::runtime_error("'" + path + "' is not a journal written by this build.");
+        }
+        size_t pos = magic.size();
+        while (pos + 4 <= data.size()) {
+            size_t size = get_le(data, pos, 4);
+            if (size < 25 || pos + 4 + size + 4 > data.size()) {
+                break;
+            }
+            size_t start = pos + 4;
+            if (fnv1a(data.data() + start, size) != get_le(data, start + size, 4)) {
+                break;
+            }
+            JournalRecord record;
+            record.op = static_cast<JournalOp>(data[start]);
+            record.timestamp = static_cast<time_t>(get_le(data, start + 1, 8));
+            record.version_id = static_cast<int>(static_cast<uint32_t>(get_le(data, start + 9, 4)));
+            record.file_id = static_cast<int>(static_cast<uint32_t>(get_le(data, start + 13, 4)));
+            size_t name_size = get_le(data, start + 17, 4);
+            if (21 + name_size + 4 > size) {
+                break;
+            }
+            record.filename = data.substr(start + 21, name_size);
+            size_t text_size = get_le(data, start + 21 + name_size, 4);
+            if (25 + name_size + text_size != size) {
+                break;
+            }
+            record.text = data.substr(start + 25 + name_size, text_size);
+            records.push_back(std::move(record));
+            pos = start + size + 4;
+        }
+        if (pos != data.size()) {
+            std::filesystem::resize_file(path, pos);
+        }
+        return records;
+    }
+
+    void append(const JournalRecord &record) {
+        // adds a record, making it durable according to the fsync policy
+        std::lock_guard guard(lock);
+        buffer += encode(record);
+        pending_records++;
+        records_written++;
+        switch (policy) {
+            case FsyncPolicy::PerOp:
+                write_buffer();
+                fsync_file();
+                break;
+            case FsyncPolicy::Group:
+                if (pending_records >= group_size) {
+                    write_buffer();
+                    fsync_file();
+                }
+                break;
+            case FsyncPolicy::Interval:
+                write_buffer();
+                if (std::chrono::steady_clock::now() - last_sync >= interval) {
+                    fsync_file();
+                } else if (pending_records == 1) {
+                    pending.notify_one(); // the flusher fsyncs it once the interval is up
+                }
+                break;
+        }
+    }
+
+    void sync() {
+        // writes and fsyncs every pending record
+        std::lock_guard guard(lock);
+        if (!buffer.empty()) {
+            write_buffer();
+        }
+        if (pending_records > 0) {
+            fsync_file();
+        }
+    }
+
+    void restart(int checkpoint_id) {
+        // replaces the journal with a single marker saying it continues the given checkpoint. The new journal is
+        // written next to the old one and renamed over it, so a crash leaves one or the other
+        std::lock_guard guard(lock);
+        std::string temporary = path + ".tmp";
+        int old_fd = fd;
+        fd = open_file(temporary, true);
+        buffer.assign(JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC));
+        buffer += encode({JournalOp::Checkpoint, time(nullptr), "", "", checkpoint_id});
+        try {
+            write_buffer();
+            fsync_file();
+        } catch (...) {
+            close_file(fd);
+            fd = old_fd;
+            buffer.clear();
+            throw;
+        }
+        close_file(fd);
+        close_file(old_fd);
+        replace_file(temporary, path);
+        fd = open_file(path, false);
+    }
+
+    size_t size() const {
+        // records appended through this journal
+        return records_written;
+    }
+};
+
+#endif
@@ -0,0 +1,149 @@
+#ifndef LZ_HPP
+#define LZ_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+// Byte oriented LZ77 block format in the style of LZ4. A block is a series of sequences, each being
+//   token: high nibble literal count, low nibble match length - LZ_MIN_MATCH (15 means more length bytes follow)
+//   [literal count extension] literals [u16 little endian offset] [match length extension]
+// where extensions are runs of 255 ended by a byte below 255. The last sequence has literals only.
+constexpr size_t LZ_MIN_MATCH = 4;
+constexpr size_t LZ_MAX_OFFSET = 65535;
+constexpr int LZ_HASH_BITS = 14;
+
+inline uint32_t lz_load32(const char *p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+inline void lz_put_length(std::string &out, size_t length) {
+    // writes the part of a length that did not fit its nibble
+    while (length >= 255) {
+        out.push_back(static_cast<char>(255));
+        length -= 255;
+    }
+    out.push_back(static_cast<char>(length));
+}
+
+inline void lz_put_sequence(std::string &out, const char *literals, size_t literal_count, size_t offset,
+                            size_t match_length) {
+    // writes one sequence, match_length 0 for the final literals-only sequence
+    size_t match_code = match_length == 0 ? 0 : match_length - LZ_MIN_MATCH;
+    unsigned char token = static_cast<unsigned char>((literal_count < 15 ? literal_count : 15) << 4 |
+                                                     (match_code < 15 ? match_code : 15));
+    out.push_back(static_cast<char>(token));
+    if (literal_count >= 15) {
+        lz_put_length(out, literal_count - 15);
+    }
+    out.append(literals, literal_count);
+    if (match_length == 0) {
+        return;
+    }
+    out.push_back(static_cast<char>(offset & 255));
+    out.push_back(static_cast<char>(offset >> 8));
+    if (match_code >= 15) {
+        lz_put_length(out, match_code - 15);
+    }
+}
+
+inline std::string lz_compress(std::string_view input) {
+    // greedy compression with a hash table of the last position each 4 byte sequence was seen at
+    std::string out;
+    out.reserve(input.size() / 2 + 16);
+    std::vector<uint32_t> table(size_t(1) << LZ_HASH_BITS, 0); // position + 1, 0 if empty
+    const char *data = input.data();
+    size_t n = input.size();
+    size_t anchor = 0; // first byte not yet written
+    size_t pos = 0;
+    while (pos + LZ_MIN_MATCH <= n) {
+        uint32_t sequence = lz_load32(data + pos);
+        uint32_t &slot = table[(sequence * 2654435761u) >> (32 - LZ_HASH_BITS)];
+        size_t candidate = slot;
+        slot = static_cast<uint32_t>(pos + 1);
+        if (candidate == 0 || pos - (candidate - 1) > LZ_MAX_OFFSET || lz_load32(data + candidate - 1) != sequence) {
+            pos++;
+            continue;
+        }
+        size_t match = candidate - 1;
+        size_t length = LZ_MIN_MATCH;
+        while (pos + length < n && data[match + length] == data[pos + length]) {
+            length++;
+        }
+        lz_put_sequence(out, data + anchor, pos - anchor, pos - match, length);
+        pos += length;
+        anchor = pos;
+    }
+    lz_put_sequence(out, data + anchor, n - anchor, 0, 0);
+    return out;
+}
+
+inline std::string lz_decompress(std::string_view packed, size_t size) {
+    // inverse of lz_compress for a block that decompresses to size bytes
+    std::string out(size, '\0');
+    const unsigned char *in = reinterpret_cast<const unsigned char *>(packed.data());
+    size_t n = packed.size();
+    size_t ip = 0;
+    size_t op = 0;
+    auto read_length = [&](size_t length) {
+        unsigned char byte;
+        do {
+            if (ip >= n) {
+                throw std::runtime_error("Compressed block is corrupt.");
+            }
+            byte = in[ip++];
+            length += byte;
+        } while (byte == 255);
+        return length;
+    };
+    while (ip < n) {
+        unsigned char token = in[ip++];
+        size_t literal_count = token >> 4;
+        if (literal_count == 15) {
+            literal_count = read_length(literal_count);
+        }
+        if (literal_count > n - ip || literal_count > size - op) {
+            throw std::runtime_error("Compressed block is corrupt.");
+        }
+        std::memcpy(out.data() + op, in + ip, literal_count);
+        ip += literal_count;
+        op += literal_count;
+        if (ip == n) {
+            break; // final sequence
+        }
+        if (n - ip < 2) {
+            throw std::runtime_error("Compressed block is corrupt.");
+        }
+        size_t offset = in[ip] | static_cast<size_t>(in[ip + 1]) << 8;
+        ip += 2;
+        size_t length = token & 15;
+        if (length == 15) {
+            length = read_length(length);
+        }
+        length += LZ_MIN_MATCH;
+        if (offset == 0 || offset > op || length > size - op) {
+            throw std::runtime_error("Compressed block is corrupt.");
+        }
+        char *dst = out.data() + op;
+        const char *src = dst - offset;
+        if (offset >= length) {
+            std::memcpy(dst, src, length);
+        } else {
+            for (size_t i = 0; i < length; i++) {
+                dst[i] = src[i]; // overlapping match repeats the last offset bytes
+            }
+        }
+        op += length;
+    }
+    if (op != size) {
+        throw std::runtime_error("Compressed block is corrupt.");
+    }
+    return out;
+}
+
+#endif
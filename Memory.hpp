@@ -0,0 +1,26 @@
+#ifndef MEMORY_HPP
+#define MEMORY_HPP
+
+#include <cstddef>
+#include <fstream>
+
+#if defined(__linux__)
+#include <unistd.h>
+#endif
+
+inline size_t resident_memory_bytes() {
+    // resident set size of this process, 0 where the platform does not expose it
+#if defined(__linux__)
+    std::ifstream statm("/proc/self/statm");
+    size_t total_pages = 0;
+    size_t resident_pages = 0;
+    if (!(statm >> total_pages >> resident_pages)) {
+        return 0;
+    }
+    return resident_pages * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#else
+    return 0;
+#endif
+}
+
+#endif
@@ -1,176 +1,205 @@
 #ifndef MYERS_HPP
 #define MYERS_HPP
 
-#include <string>
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
 #include <vector>
-#include <queue>
-#include <utility>
-#include <sstream>
-#include <iostream>
 
-struct DiffLine {
-    // struct for line and status
-    char c;
-    std::string line;
+template<typename T>
+class MyersDiff {
+    // Myers' O((N+M)D) diff in linear space ("An O(ND) Difference Algorithm and Its Variations", section 4b): the
+    // middle snake of the shortest edit script is found by running the greedy search from both ends until the two
+    // meet, then each side of it is solved the same way. Only two diagonal arrays of N+M+2 ints are kept, and the
+    // result is a mark on every deleted line of A and every inserted line of B, as GNU diff does.
+private:
+    const T *a; // old lines
+    const T *b; // new lines
+    std::vector<int> forward; // furthest x reached on every diagonal k = x - y, offset by the largest D
+    std::vector<int> backward; // furthest x reached from the end on every diagonal, offset the same way
+    std::vector<char> &deleted;
+    std::vector<char> &inserted;
 
-    DiffLine(int i, const std::string &line) {
-        if (i == 0) {
-            c = ' ';
-        } else if (i == 1) {
-            c = '+';
-        } else {
-            c = '-';
-        }
-        this->line = line;
-    }
-};
+    struct Range {
+        int a_begin;
+        int a_end;
+        int b_begin;
+        int b_end;
+    };
 
-inline std::vector<DiffLine> getdifflines(const std::vector<std::string> &A, const std::vector<std::string> &B,
-                                          const std::vector<std::vector<std::pair<int, int> > > &parent) {
-    // returns vector of difflines when end is reached
-    int m = A.size();
-    int n = B.size();
-    int i = n;
-    int j = m;
-    std::vector<DiffLine> difflines;
-    while (i > 0 || j > 0) {
-        if (parent[i][j].first == i - 1 && parent[i][j].second == j - 1) {
-            difflines.push_back({0, B[i - 1]});
-        } else if (parent[i][j].first == i && parent[i][j].second == j - 1) {
-            difflines.push_back({2, A[j - 1]});
-        } else if (parent[i][j].first == i - 1 && parent[i][j].second == j) {
-            difflines.push_back({1, B[i - 1]});
-        }
-        std::pair<int, int> temp = parent[i][j];
-        i = temp.first;
-        j = temp.second;
-    }
-    return std::vector<DiffLine>(difflines.rbegin(), difflines.rend());
-}
+    struct Split {
+        // point on a shortest edit script of the range, with the number of edits on each side of it
+        int x;
+        int y;
+    };
 
-inline std::vector<DiffLine> diff(const std::vector<std::string> &A, const std::vector<std::string> &B) {
-    // Implementation of Myers Algorithm using BFS. https://blog.jcoglan.com/2017/02/12/the-myers-diff-algorithm-part-1/
-    int m = A.size();
-    int n = B.size();
-    std::vector<DiffLine> difflines;
-    if (m == 0 && n == 0) {
-        return difflines;
-    }
-    if (m == 0) {
-        for (int i = 0; i < n; i++) {
-            difflines.push_back({1, B[i]});
-        }
-        return difflines;
-    }
-    if (n == 0) {
-        for (int i = 0; i < m; i++) {
-            difflines.push_back({2, A[i]});
-        }
-        return difflines;
-    }
-    std::queue<std::pair<int, int> > q;
-    std::vector<std::vector<std::pair<int, int> > > parent(n + 1, std::vector<std::pair<int, int> >(m + 1, {-1, -1}));
-    q.push({0, 0});
-    while (!(q.empty())) {
-        std::pair<int, int> c = q.front();
-        q.pop();
-        if (c == std::pair<int, int>(0, 0)) {
-            int i = 0;
-            int j = 0;
-            while (i + 1 <= n && j + 1 <= m) {
-                if (A[j] == B[i]) {
-                    parent[i + 1][j + 1] = {i, j};
-                    if (i + 1 == n && j + 1 == m) {
-                        return getdifflines(A, B, parent);
-                    }
-                    q.push({i + 1, j + 1});
-                    i++;
-                    j++;
+    Split middle_snake(int a_begin, int a_end, int b_begin, int b_end, std::vector<int> &forward,
+                       std::vector<int> &backward) const {
+        // finds a point where the forward and backward searches over a[a_begin, a_end) and b[b_begin, b_end)
+        // overlap, both ranges being non-empty and differing in their first and last lines. Forward and backward
+        // hold at least N+M+3 ints of the range
+        int n = a_end - a_begin;
+        int m = b_end - b_begin;
+        int max_d = (n + m + 1) / 2;
+        int offset = max_d;
+        int delta = n - m;
+        bool odd = (delta & 1) != 0; // the forward search finds the overlap, else the backward one
+        std::fill(forward.begin(), forward.begin() + 2 * max_d + 2, -1);
+        std::fill(backward.begin(), backward.begin() + 2 * max_d + 2, -1);
+        forward[offset + 1] = 0;
+        backward[offset + 1] = 0;
+        // diagonals trimmed from either end of the searched band once their path runs off the grid
+        int forward_start = 0, forward_end = 0, backward_start = 0, backward_end = 0;
+        for (int d = 0; d <= max_d; d++) {
+            for (int k = -d + forward_start; k <= d - forward_end; k += 2) {
+                // forward: extend diagonal k = x - y by one edit, then along its snake
+                int x;
+                if (k == -d || (k != d && forward[offset + k - 1] < forward[offset + k + 1])) {
+                    x = forward[offset + k + 1]; // insertion
                 } else {
-                    break;
+                    x = forward[offset + k - 1] + 1; // deletion
                 }
-            }
-        }
-        if (c.second + 1 <= m && parent[c.first][c.second + 1] == std::pair<int, int>(-1, -1)) {
-            parent[c.first][c.second + 1] = {c.first, c.second};
-            if (c.first == n && c.second + 1 == m) {
-                return getdifflines(A, B, parent);
-            }
-
-            q.push({c.first, c.second + 1});
-            int i = c.first;
-            int j = c.second + 1;
-            while (i + 1 <= n && j + 1 <= m) {
-                if (A[j] == B[i] && parent[i + 1][j + 1] == std::pair<int, int>(-1, -1)) {
-                    parent[i + 1][j + 1] = {i, j};
-                    if (i + 1 == n && j + 1 == m) {
-                        return getdifflines(A, B, parent);
+                int y = x - k;
+                while (x < n && y < m && a[a_begin + x] == b[b_begin + y]) {
+                    x++;
+                    y++;
+                }
+                forward[offset + k] = x;
+                if (x > n) {
+                    forward_end += 2;
+                } else if (y > m) {
+                    forward_start += 2;
+                } else if (odd) {
+                    int reverse = offset + delta - k;
+                    if (reverse >= 0 && reverse < 2 * max_d + 2 && backward[reverse] != -1 &&
+                        x >= n - backward[reverse]) {
+                        return {a_begin + x, b_begin + y};
                     }
-                    q.push({i + 1, j + 1});
-                    i++;
-                    j++;
-                } else {
-                    break;
                 }
             }
-        }
-        if (c.first + 1 <= n && parent[c.first + 1][c.second] == std::pair<int, int>(-1, -1)) {
-            parent[c.first + 1][c.second] = {c.first, c.second};
-            if (c.first + 1 == n && c.second == m) {
-                return getdifflines(A, B, parent);
-            }
-            q.push({c.first + 1, c.second});
-            int i = c.first + 1;
-            int j = c.second;
-            while (i + 1 <= n && j + 1 <= m) {
-                if (A[j] == B[i] && parent[i + 1][j + 1] == std::pair<int, int>(-1, -1)) {
-                    parent[i + 1][j + 1] = {i, j};
-                    if (i + 1 == n && j + 1 == m) {
-                        return getdifflines(A, B, parent);
-                    }
-                    q.push({i + 1, j + 1});
-                    i++;
-                    j++;
+            for (int k = -d + backward_start; k <= d - backward_end; k += 2) {
+                // backward: the same from the ends of both ranges
+                int x;
+                if (k == -d || (k != d && backward[offset + k - 1] < backward[offset + k + 1])) {
+                    x = backward[offset + k + 1];
                 } else {
-                    break;
+                    x = backward[offset + k - 1] + 1;
+                }
+                int y = x - k;
+                while (x < n && y < m && a[a_end - x - 1] == b[b_end - y - 1]) {
+                    x++;
+                    y++;
+                }
+                backward[offset + k] = x;
+                if (x > n) {
+                    backward_end += 2;
+                } else if (y > m) {
+                    backward_start += 2;
+                } else if (!odd) {
+                    int ahead = offset + delta - k;
+                    if (ahead >= 0 && ahead < 2 * max_d + 2 && forward[ahead] != -1 && forward[ahead] >= n - x) {
+                        // split where the forward path reached, which lies on the same shortest script
+                        return {a_begin + forward[ahead], b_begin + forward[ahead] - (ahead - offset)};
+                    }
                 }
             }
         }
+        throw std::logic_error("Myers diff found no middle snake.");
+    }
+
+public:
+    MyersDiff(const std::vector<T> &A, const std::vector<T> &B, std::vector<char> &deleted,
+              std::vector<char> &inserted) : a(A.data()), b(B.data()), deleted(deleted), inserted(inserted) {
+        // prepares to mark a shortest edit script of A into B: deleted[i] for every line of A and inserted[j] for
+        // every line of B that is not part of the longest common subsequence. Nothing is marked yet
+        if (A.size() + B.size() >= static_cast<size_t>(INT32_MAX / 2)) {
+            throw std::length_error("Versions are too long to compare.");
+        }
+        deleted.assign(A.size(), 0);
+        inserted.assign(B.size(), 0);
+        forward.resize(A.size() + B.size() + 5);
+        backward.resize(A.size() + B.size() + 5);
     }
-    return difflines;
-}
 
-inline std::vector<std::string> getStVec(const std::string &input) {
-    // get vector of strings from multiline string
-    std::vector<std::string> lines;
-    std::istringstream iss(input);
-    std::string line;
+    void compare(int a_begin, int a_end, int b_begin, int b_end) {
+        // marks a shortest edit script of a[a_begin, a_end) into b[b_begin, b_end)
+        compare({a_begin, a_end, b_begin, b_end}, forward, backward);
+    }
 
-    while (std::getline(iss, line)) {
-        lines.push_back(line);
+    void compare() {
+        // marks a shortest edit script of all of A into all of B
+        compare(0, static_cast<int>(deleted.size()), 0, static_cast<int>(inserted.size()));
     }
 
-    return lines;
-}
+    void compare(ThreadPool &pool) {
+        // marks the same script as compare(), on the pool. The sides of a middle snake are independent, so middle
+        // snakes are found level by level, every range of a level in parallel, until there are a few ranges per
+        // thread, and those are then solved in parallel. Ranges mark disjoint lines. The first middle snake is
+        // found on one thread and costs about half of the whole search, which bounds the speedup near 2
+        std::vector<Range> level = {{0, static_cast<int>(deleted.size()), 0, static_cast<int>(inserted.size())}};
+        std::vector<Range> halves;
+        size_t ranges = static_cast<size_t>(pool.size()) * 4;
+        while (!level.empty() && level.size() < ranges) {
+            halves.assign(level.size() * 2, Range{0, 0, 0, 0});
+            pool.parallel_for(level.size(), [&](size_t r) {
+                Range range = level[r];
+                if (narrow(range)) {
+                    std::vector<int> range_forward(diagonals(range)), range_backward(diagonals(range));
+                    Split split = middle_snake(range.a_begin, range.a_end, range.b_begin, range.b_end,
+                                               range_forward, range_backward);
+                    halves[2 * r] = {range.a_begin, split.x, range.b_begin, split.y};
+                    halves[2 * r + 1] = {split.x, range.a_end, split.y, range.b_end};
+                }
+            });
+            level.clear();
+            for (const Range &half: halves) {
+                if (half.a_begin < half.a_end || half.b_begin < half.b_end) {
+                    level.push_back(half);
+                }
+            }
+        }
+        pool.parallel_for(level.size(), [&](size_t r) {
+            std::vector<int> range_forward(diagonals(level[r])), range_backward(diagonals(level[r]));
+            compare(level[r], range_forward, range_backward);
+        });
+    }
 
+    bool narrow(Range &range) const {
+        // drops the common ends of range and marks it if a side is left empty, true if both sides are left
+        while (range.a_begin < range.a_end && range.b_begin < range.b_end && a[range.a_begin] == b[range.b_begin]) {
+            range.a_begin++;
+            range.b_begin++;
+        }
+        while (range.a_begin < range.a_end && range.b_begin < range.b_end &&
+               a[range.a_end - 1] == b[range.b_end - 1]) {
+            range.a_end--;
+            range.b_end--;
+        }
+        if (range.a_begin == range.a_end) {
+            std::fill(inserted.begin() + range.b_begin, inserted.begin() + range.b_end, 1);
+            return false;
+        }
+        if (range.b_begin == range.b_end) {
+            std::fill(deleted.begin() + range.a_begin, deleted.begin() + range.a_end, 1);
+            return false;
+        }
+        return true;
+    }
 
-inline void printdiff(const std::string &A, const std::string &B) {
-    // prints diff from diffline array
-    std::vector<DiffLine> outs = diff(getStVec(A), getStVec(B));
-    for (const DiffLine &l: outs) {
-        switch (l.c) {
-            case '+':
-                std::cout << "\033[1;32;47m" << l.c << " " << l.line << "\n";
-                break;
-            case '-':
-                std::cout << "\033[1;31;47m" << l.c << " " << l.line << "\n";
-                break;
-            default:
-                std::cout << "\033[1;34;47m" << l.c << " " << l.line << "\n";
-                break;
+    void compare(Range range, std::vector<int> &forward, std::vector<int> &backward) {
+        // marks a shortest edit script of range, splitting it at middle snakes found with the given arrays
+        if (narrow(range)) {
+            Split split = middle_snake(range.a_begin, range.a_end, range.b_begin, range.b_end, forward, backward);
+            compare({range.a_begin, split.x, range.b_begin, split.y}, forward, backward);
+            compare({split.x, range.a_end, split.y, range.b_end}, forward, backward);
         }
     }
-    std::cout << "\033[0m" << "\n";
-}
+
+    static size_t diagonals(const Range &range) {
+        // ints the diagonal arrays of middle_snake need for range
+        return static_cast<size_t>(range.a_end - range.a_begin) + (range.b_end - range.b_begin) + 5;
+    }
+};
 
 #endif
@@ -0,0 +1,169 @@
+#ifndef PATIENCE_HPP
+#define PATIENCE_HPP
+
+#include "Myers.hpp"
+#include <algorithm>
+#include <vector>
+
+class PatienceDiff {
+    // Patience diff (as in bzr and git --patience) over interned line IDs: lines that occur exactly once in both
+    // ranges are paired, the longest chain of pairs in the same order on both sides is kept as anchors by patience
+    // sorting, and the gaps between anchors are diffed the same way. A gap with no unique lines goes to Myers. Lines
+    // such as braces and blank lines never anchor, so a moved or rewritten block is reported as one block instead of
+    // being matched line by line against unrelated repeats.
+public:
+    struct Range {
+        int a_begin;
+        int a_end;
+        int b_begin;
+        int b_end;
+    };
+
+    struct Match {
+        int a; // index in A
+        int b; // index in B
+    };
+
+    static void longest_chain(const std::vector<Match> &matches, std::vector<int> &piles, std::vector<int> &below,
+                              std::vector<Match> &chain) {
+        // longest chain of matches, given in B order, that is also in A order, by patience sorting: each match goes
+        // on the leftmost pile whose top lies after it in A, and the chain is read back from the last pile. Piles
+        // and below are scratch space
+        piles.clear();
+        below.resize(matches.size());
+        for (int k = 0; k < static_cast<int>(matches.size()); k++) {
+            // matches mostly arrive in A order, so most extend the last pile without a search
+            auto pile = !piles.empty() && matches[piles.back()].a < matches[k].a
+                            ? piles.end()
+                            : std::partition_point(piles.begin(), piles.end(), [&](int top) {
+                                return matches[top].a < matches[k].a;
+                            });
+            below[k] = pile == piles.begin() ? -1 : *(pile - 1);
+            if (pile == piles.end()) {
+                piles.push_back(k);
+            } else {
+                *pile = k;
+            }
+        }
+        chain.clear();
+        for (int k = piles.empty() ? -1 : piles.back(); k != -1; k = below[k]) {
+            chain.push_back(matches[k]);
+        }
+        std::reverse(chain.begin(), chain.end());
+    }
+
+private:
+    const std::vector<int> &a;
+    const std::vector<int> &b;
+    std::vector<char> &deleted;
+    std::vector<char> &inserted;
+    MyersDiff<int> myers; // for gaps without unique lines
+    std::vector<int> a_count; // occurrences of every ID in the range being diffed, zero between ranges
+    std::vector<int> b_count;
+    std::vector<int> a_position; // index in A of the last occurrence of every ID in the range
+    std::vector<Match> matches; // lines unique on both sides, in B order
+    std::vector<Match> anchors; // longest chain of matches
+    std::vector<int> piles; // scratch space for longest_chain
+    std::vector<int> below;
+    std::vector<Range> pending; // ranges still to diff
+
+    void split(const Range &range) {
+        // marks range if it is trivial, else queues the gaps between its anchors or hands it to Myers
+        int a_begin = range.a_begin, a_end = range.a_end, b_begin = range.b_begin, b_end = range.b_end;
+        while (a_begin < a_end && b_begin < b_end && a[a_begin] == b[b_begin]) {
+            a_begin++;
+            b_begin++;
+        }
+        while (a_begin < a_end && b_begin < b_end && a[a_end - 1] == b[b_end - 1]) {
+            a_end--;
+            b_end--;
+        }
+        if (a_begin == a_end) {
+            std::fill(inserted.begin() + b_begin, inserted.begin() + b_end, 1);
+            return;
+        }
+        if (b_begin == b_end) {
+            std::fill(deleted.begin() + a_begin, deleted.begin() + a_end, 1);
+            return;
+        }
+
+        for (int i = a_begin; i < a_end; i++) {
+            a_count[a[i]]++;
+            a_position[a[i]] = i;
+        }
+        for (int j = b_begin; j < b_end; j++) {
+            b_count[b[j]]++;
+        }
+        matches.clear();
+        for (int j = b_begin; j < b_end; j++) {
+            if (a_count[b[j]] == 1 && b_count[b[j]] == 1) {
+                matches.push_back({a_position[b[j]], j});
+            }
+        }
+        for (int i = a_begin; i < a_end; i++) {
+            a_count[a[i]] = 0;
+        }
+        for (int j = b_begin; j < b_end; j++) {
+            b_count[b[j]] = 0;
+        }
+        if (matches.empty()) {
+            myers.compare(a_begin, a_end, b_begin, b_end);
+            return;
+        }
+
+        longest_chain(matches, piles, below, anchors);
+        int next_a = a_begin;
+        int next_b = b_begin;
+        for (const Match &anchor: anchors) {
+            pending.push_back({next_a, anchor.a, next_b, anchor.b});
+            next_a = anchor.a + 1;
+            next_b = anchor.b + 1;
+        }
+        pending.push_back({next_a, a_end, next_b, b_end});
+    }
+
+public:
+    PatienceDiff(const std::vector<int> &A, const std::vector<int> &B, std::vector<char> &deleted,
+                 std::vector<char> &inserted) : a(A), b(B), deleted(deleted), inserted(inserted),
+                                                myers(A, B, deleted, inserted) {
+        // prepares to mark an edit script of A into B, whose IDs are small non-negative ints
+        int ids = 0;
+        for (const std::vector<int> *lines: {&A, &B}) {
+            for (int id: *lines) {
+                ids = std::max(ids, id + 1);
+            }
+        }
+        a_count.assign(ids, 0);
+        b_count.assign(ids, 0);
+        a_position.assign(ids, 0);
+    }
+
+    void split_until(size_t ranges, std::vector<Range> &unsolved) {
+        // splits level by level, marking the ranges that turn out trivial or go to Myers, until at least ranges
+        // are left or none is; those are handed to unsolved instead of being split further. Each depends only on
+        // its own lines, so comparing them apart, IDs renumbered or not, marks what compare() would
+        pending.assign(1, {0, static_cast<int>(a.size()), 0, static_cast<int>(b.size())});
+        std::vector<Range> level;
+        while (!(pending.empty()) && pending.size() < ranges) {
+            level.swap(pending);
+            pending.clear();
+            for (const Range &range: level) {
+                split(range);
+            }
+        }
+        unsolved.swap(pending);
+        pending.clear();
+    }
+
+    void compare() {
+        // marks deleted[i] and inserted[j] for every line of A and B outside the anchored common subsequence
+        pending.push_back({0, static_cast<int>(a.size()), 0, static_cast<int>(b.size())});
+        while (!(pending.empty())) {
+            Range range = pending.back();
+            pending.pop_back();
+            split(range);
+        }
+    }
+};
+
+#endif
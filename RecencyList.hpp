@@ -0,0 +1,139 @@
+#ifndef RECENCYLIST_HPP
+#define RECENCYLIST_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+class RecencyList {
+    // Small non-negative int keys, such as interned file IDs, in the order they were last touched, most recent
+    // first. A doubly linked list threaded through arrays indexed by key: touching a key unlinks it and relinks it
+    // at the front in O(1) without allocating, and the first k keys are read in O(k). Keys touched in the same
+    // second keep the order they were touched in.
+private:
+    static constexpr int NONE = -1; // end of the list
+    static constexpr int ABSENT = -2; // prev of a key not in the list
+
+    std::vector<int> prev; // neighbour towards the front, ABSENT if the key is not in the list
+    std::vector<int> next; // neighbour towards the back
+    int head = NONE; // most recently touched
+    int tail = NONE; // least recently touched
+    size_t current_size = 0;
+
+    void reserve_key(int key) {
+        // grows the arrays to hold key
+        if (key < 0) {
+            throw std::invalid_argument("RecencyList keys must be non-negative.");
+        }
+        if (static_cast<size_t>(key) >= prev.size()) {
+            size_t grown = std::max(static_cast<size_t>(key) + 1, prev.size() * 2);
+            prev.resize(grown, ABSENT);
+            next.resize(grown, NONE);
+        }
+    }
+
+    void unlink(int key) {
+        // takes a present key out of the list
+        if (prev[key] == NONE) {
+            head = next[key];
+        } else {
+            next[prev[key]] = next[key];
+        }
+        if (next[key] == NONE) {
+            tail = prev[key];
+        } else {
+            prev[next[key]] = prev[key];
+        }
+        prev[key] = ABSENT;
+        next[key] = NONE;
+        current_size--;
+    }
+
+public:
+    size_t size() const {
+        // number of keys in the list
+        return current_size;
+    }
+
+    bool empty() const {
+        // if the list is empty
+        return current_size == 0;
+    }
+
+    bool contains(int key) const {
+        // if key is in the list
+        return key >= 0 && static_cast<size_t>(key) < prev.size() && prev[key] != ABSENT;
+    }
+
+    int front() const {
+        // most recently touched key
+        if (empty()) {
+            throw std::out_of_range("RecencyList is empty.");
+        }
+        return head;
+    }
+
+    void touch(int key) {
+        // moves key to the front, adding it if absent
+        reserve_key(key);
+        if (prev[key] != ABSENT) {
+            if (key == head) {
+                return;
+            }
+            unlink(key);
+        }
+        prev[key] = NONE;
+        next[key] = head;
+        if (head == NONE) {
+            tail = key;
+        } else {
+            prev[head] = key;
+        }
+        head = key;
+        current_size++;
+    }
+
+    void push_back(int key) {
+        // adds an absent key as the least recently touched, to restore a saved order front to back
+        reserve_key(key);
+        if (prev[key] != ABSENT) {
+            throw std::invalid_argument("Key already exists in RecencyList.");
+        }
+        prev[key] = tail;
+        next[key] = NONE;
+        if (tail == NONE) {
+            head = key;
+        } else {
+            next[tail] = key;
+        }
+        tail = key;
+        current_size++;
+    }
+
+    void remove(int key) {
+        // removes key if present
+        if (contains(key)) {
+            unlink(key);
+        }
+    }
+
+    void clear() {
+        // removes every key, keeping the arrays
+        std::fill(prev.begin(), prev.end(), ABSENT);
+        std::fill(next.begin(), next.end(), NONE);
+        head = tail = NONE;
+        current_size = 0;
+    }
+
+    template<typename Visitor>
+    void for_each(Visitor visit, size_t limit = SIZE_MAX) const {
+        // calls visit(key) for the first limit keys, most recently touched first
+        for (int key = head; key != NONE && limit > 0; key = next[key], limit--) {
+            visit(key);
+        }
+    }
+};
+
+#endif
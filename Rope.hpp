@@ -0,0 +1,323 @@
+#ifndef ROPE_HPP
+#define ROPE_HPP
+
+#include "BlobStore.hpp"
+#include <string>
+#include <vector>
+#include <ostream>
+#include <utility>
+#include <cstddef>
+
+struct RopeNode {
+    // immutable node of a persistent AVL rope, shared between every version that contains it
+    RopeNode *left; // nullptr for leaves
+    RopeNode *right; // nullptr for leaves
+    Blob *blob; // piece source, leaves only
+    size_t offset; // start of piece in blob, leaves only
+    size_t length; // bytes under this node
+    size_t pieces; // leaves under this node
+    int height; // 1 for leaves
+    int refcount;
+
+    static inline size_t live = 0; // nodes currently allocated
+};
+
+class Rope {
+    // Persistent rope of blob pieces. Copies share structure, appends and slices are O(log pieces)
+private:
+    RopeNode *root;
+    BlobStore *store;
+
+    static int height(const RopeNode *node) {
+        return node == nullptr ? 0 : node->height;
+    }
+
+    static void retain(RopeNode *node) {
+        if (node != nullptr) {
+            node->refcount++;
+        }
+    }
+
+    static void release(RopeNode *node, BlobStore *store) {
+        // drops a reference, freeing the node and its unshared children
+        std::vector<RopeNode *> stack;
+        if (node != nullptr) {
+            stack.push_back(node);
+        }
+        while (!stack.empty()) {
+            RopeNode *current = stack.back();
+            stack.pop_back();
+            if (--current->refcount > 0) {
+                continue;
+            }
+            if (current->blob != nullptr) {
+                store->release(current->blob);
+            } else {
+                stack.push_back(current->left);
+                stack.push_back(current->right);
+            }
+            delete current;
+            RopeNode::live--;
+        }
+    }
+
+    static RopeNode *leaf(Blob *blob, size_t offset, size_t length, BlobStore *store) {
+        // creates a leaf over blob[offset, offset + length), taking a reference to blob
+        store->retain(blob);
+        RopeNode::live++;
+        return new RopeNode{nullptr, nullptr, blob, offset, length, 1, 1, 1};
+    }
+
+    static RopeNode *node(RopeNode *left, RopeNode *right) {
+        // creates an internal node, taking ownership of both children
+        RopeNode::live++;
+        int h = (height(left) > height(right) ? height(left) : height(right)) + 1;
+        return new RopeNode{
+            left, right, nullptr, 0, left->length + right->length, left->pieces + right->pieces, h, 1
+        };
+    }
+
+    static RopeNode *balance(RopeNode *left, RopeNode *right, BlobStore *store) {
+        // joins two owned subtrees whose heights differ by at most 2, rotating if needed
+        if (height(left) > height(right) + 1) {
+            RopeNode *x = left->left;
+            RopeNode *y = left->right;
+            retain(x);
+            retain(y);
+            release(left, store);
+            if (height(x) >= height(y)) {
+                return node(x, node(y, right));
+            }
+            RopeNode *y1 = y->left;
+            RopeNode *y2 = y->right;
+            retain(y1);
+            retain(y2);
+            release(y, store);
+            return node(node(x, y1), node(y2, right));
+        }
+        if (height(right) > height(left) + 1) {
+            RopeNode *x = right->right;
+            RopeNode *y = right->left;
+            retain(x);
+            retain(y);
+            release(right, store);
+            if (height(x) >= height(y)) {
+                return node(node(left, y), x);
+            }
+            RopeNode *y1 = y->left;
+            RopeNode *y2 = y->right;
+            retain(y1);
+            retain(y2);
+            release(y, store);
+            return node(node(left, y1), node(y2, x));
+        }
+        return node(left, right);
+    }
+
+    static RopeNode *join(RopeNode *left, RopeNode *right, BlobStore *store) {
+        // concatenates two owned subtrees in O(|height difference|)
+        if (left == nullptr) {
+            return right;
+        }
+        if (right == nullptr) {
+            return left;
+        }
+        if (height(left) > height(right) + 1) {
+            RopeNode *l = left->left;
+            RopeNode *r = left->right;
+            retain(l);
+            retain(r);
+            release(left, store);
+            return balance(l, join(r, right, store), store);
+        }
+        if (height(right) > height(left) + 1) {
+            RopeNode *l = right->left;
+            RopeNode *r = right->right;
+            retain(l);
+            retain(r);
+            release(right, store);
+            return balance(join(left, l, store), r, store);
+        }
+        return node(left, right);
+    }
+
+    static std::pair<RopeNode *, RopeNode *> split(RopeNode *node, size_t pos, BlobStore *store) {
+        // splits a borrowed subtree into owned [0, pos) and [pos, length)
+        if (pos == 0) {
+            retain(node);
+            return {nullptr, node};
+        }
+        if (pos >= node->length) {
+            retain(node);
+            return {node, nullptr};
+        }
+        if (node->blob != nullptr) {
+            return {
+                leaf(node->blob, node->offset, pos, store),
+                leaf(node->blob, node->offset + pos, node->length - pos, store)
+            };
+        }
+        if (pos <= node->left->length) {
+            auto [a, b] = split(node->left, pos, store);
+            retain(node->right);
+            return {a, join(b, node->right, store)};
+        }
+        auto [a, b] = split(node->right, pos - node->left->length, store);
+        retain(node->left);
+        return {join(node->left, a, store), b};
+    }
+
+    Rope(RopeNode *root, BlobStore *store) {
+        // wraps an owned subtree
+        this->root = root;
+        this->store = store;
+    }
+
+public:
+    Rope() {
+        // empty rope
+        root = nullptr;
+        store = nullptr;
+    }
+
+    Rope(BlobStore &store, const std::string &text) {
+        // single piece rope over the interned blob of text
+        this->store = &store;
+        root = nullptr;
+        if (!text.empty()) {
+            Blob *blob = store.intern(text);
+            root = leaf(blob, 0, text.size(), &store);
+            store.release(blob);
+        }
+    }
+
+    Rope(const Rope &other) {
+        root = other.root;
+        store = other.store;
+        retain(root);
+    }
+
+    Rope(Rope &&other) noexcept {
+        root = other.root;
+        store = other.store;
+        other.root = nullptr;
+    }
+
+    Rope &operator=(Rope other) {
+        std::swap(root, other.root);
+        std::swap(store, other.store);
+        return *this;
+    }
+
+    ~Rope() {
+        release(root, store);
+    }
+
+    size_t size() const {
+        // length of content in bytes
+        return root == nullptr ? 0 : root->length;
+    }
+
+    size_t pieces() const {
+        // number of blob pieces making up the content
+        return root == nullptr ? 0 : root->pieces;
+    }
+
+    Rope operator+(const Rope &other) const {
+        // concatenation sharing both operands, O(log pieces)
+        retain(root);
+        retain(other.root);
+        return Rope(join(root, other.root, store != nullptr ? store : other.store),
+                    store != nullptr ? store : other.store);
+    }
+
+    Rope slice(size_t pos, size_t length) const {
+        // bytes [pos, pos + length) sharing pieces with this rope, O(log pieces)
+        if (root == nullptr || length == 0 || pos >= size()) {
+            return Rope(nullptr, store);
+        }
+        auto [head, rest] = split(root, pos, store);
+        release(head, store);
+        if (rest == nullptr) {
+            return Rope(nullptr, store);
+        }
+        auto [middle, tail] = split(rest, length, store);
+        release(rest, store);
+        release(tail, store);
+        return Rope(middle, store);
+    }
+
+    template<typename Visitor>
+    void for_each_piece(Visitor visit) const {
+        // calls visit(const char *data, size_t length) for every piece in order, loading evicted blobs
+        std::vector<const RopeNode *> stack;
+        const RopeNode *current = root;
+        while (current != nullptr || !stack.empty()) {
+            while (current != nullptr) {
+                stack.push_back(current);
+                current = current->left;
+            }
+            current = stack.back();
+            stack.pop_back();
+            if (current->blob != nullptr) {
+                visit(store->fetch(current->blob).data() + current->offset, current->length);
+            }
+            current = current->right;
+        }
+    }
+
+    void write(std::ostream &out) const {
+        // streams content piece by piece without building a contiguous copy
+        for_each_piece([&out](const char *data, size_t length) {
+            out.write(data, static_cast<std::streamsize>(length));
+        });
+    }
+
+    std::string str() const {
+        // contiguous copy of content
+        std::string out;
+        out.reserve(size());
+        for_each_piece([&out](const char *data, size_t length) {
+            out.append(data, length);
+        });
+        return out;
+    }
+
+    Rope compact() const {
+        // single piece copy of this rope
+        if (store == nullptr || pieces() <= 1) {
+            return *this;
+        }
+        return Rope(*store, str());
+    }
+
+    const RopeNode *root_node() const {
+        // root of the tree, nullptr if empty, for walking its shape when saving a checkpoint
+        return root;
+    }
+
+    static Rope from_piece(BlobStore &store, Blob *blob, size_t offset, size_t length) {
+        // single piece rope over blob[offset, offset + length), taking a reference to blob
+        return Rope(leaf(blob, offset, length, &store), &store);
+    }
+
+    static Rope from_children(const Rope &left, const Rope &right) {
+        // rope whose root has exactly these two subtrees, sharing them. Used to restore a saved, already
+        // balanced shape node by node, so no rebalancing happens
+        retain(left.root);
+        retain(right.root);
+        return Rope(node(left.root, right.root), left.store);
+    }
+
+    static size_t live_nodes() {
+        // rope nodes currently allocated across all ropes
+        return RopeNode::live;
+    }
+};
+
+inline std::ostream &operator<<(std::ostream &out, const Rope &rope) {
+    rope.write(out);
+    return out;
+}
+
+#endif
@@ -0,0 +1,211 @@
+#ifndef SKIPLIST_HPP
+#define SKIPLIST_HPP
+
+#include "HashMap.hpp"
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <vector>
+
+template<typename V, typename Compare = std::less<V> >
+class SkipList {
+    // Small non-negative int keys, such as interned file IDs, ordered by a value each, ties by key. A skip list
+    // whose towers live in one flat array of next keys: a key gets its tower the first time it is inserted and keeps
+    // it when it is removed or moved, so changing a value relinks the tower in O(log N) without allocating. Tower
+    // heights are drawn from the hash of the key, which makes the layout the same on every run.
+public:
+    struct Position {
+        // a place in the order: just after key with value, or before every key with value if key is -1
+        V value;
+        int key;
+    };
+
+private:
+    static constexpr int NONE = -1; // end of a level
+    static constexpr int HEAD = -1; // node before every key, owns the first MAX_LEVEL links
+    static constexpr int MAX_LEVEL = 32;
+    static constexpr uint32_t NO_TOWER = UINT32_MAX;
+
+    std::vector<int> links; // links[tower[key] + level] is the next key on that level, the head tower first
+    std::vector<uint32_t> tower; // start of every key's tower in links, NO_TOWER until it is first inserted
+    std::vector<uint8_t> height; // levels of every key's tower
+    std::vector<uint8_t> present; // 1 if the key is in the list
+    std::vector<V> values;
+    int levels = 1; // levels in use
+    size_t current_size = 0;
+    Compare comp;
+
+    int &next(int node, int level) {
+        // next key after node on level
+        return links[(node == HEAD ? 0 : tower[node]) + level];
+    }
+
+    int next(int node, int level) const {
+        return links[(node == HEAD ? 0 : tower[node]) + level];
+    }
+
+    bool before(int key, const Position &position) const {
+        // checks if key comes before position
+        if (comp(values[key], position.value)) {
+            return true;
+        }
+        return !comp(position.value, values[key]) && key <= position.key;
+    }
+
+    int find(const Position &position, int *path) const {
+        // returns the last node before or at position on level 0, filling path with the one on every level
+        int node = HEAD;
+        for (int level = levels - 1; level >= 0; level--) {
+            for (int ahead = next(node, level); ahead != NONE && before(ahead, position); ahead = next(node, level)) {
+                node = ahead;
+            }
+            if (path != nullptr) {
+                path[level] = node;
+            }
+        }
+        return node;
+    }
+
+    static int draw_height(int key) {
+        // one level more for every trailing zero bit of the key's hash, so each level holds about half the one below
+        uint64_t hash = hash_int(static_cast<uint64_t>(key));
+        return std::min(std::countr_zero(hash | (uint64_t{1} << (MAX_LEVEL - 1))) + 1, MAX_LEVEL);
+    }
+
+    void link(int key) {
+        // links a present key into the list at its value
+        int path[MAX_LEVEL];
+        find({values[key], key - 1}, path);
+        for (int level = levels; level < height[key]; level++) {
+            path[level] = HEAD;
+        }
+        levels = std::max(levels, static_cast<int>(height[key]));
+        for (int level = 0; level < height[key]; level++) {
+            next(key, level) = next(path[level], level);
+            next(path[level], level) = key;
+        }
+    }
+
+    void unlink(int key) {
+        // takes a present key out of the list
+        int path[MAX_LEVEL];
+        find({values[key], key - 1}, path);
+        for (int level = 0; level < height[key] && level < levels; level++) {
+            if (next(path[level], level) == key) {
+                next(path[level], level) = next(key, level);
+            }
+        }
+        while (levels > 1 && next(HEAD, levels - 1) == NONE) {
+            levels--;
+        }
+    }
+
+public:
+    SkipList() : links(MAX_LEVEL, NONE) {
+        // constructor
+    }
+
+    size_t size() const {
+        // number of keys
+        return current_size;
+    }
+
+    bool empty() const {
+        // if there are no keys
+        return current_size == 0;
+    }
+
+    bool contains(int key) const {
+        // if key is present
+        return key >= 0 && static_cast<size_t>(key) < present.size() && present[key];
+    }
+
+    const V &get(int key) const {
+        // returns value of key if present
+        if (!(contains(key))) {
+            throw std::out_of_range("Key not in SkipList.");
+        }
+        return values[key];
+    }
+
+    Position position(int key) const {
+        // place of a present key, to continue after it
+        return {get(key), key};
+    }
+
+    void insert(int key, const V &value) {
+        // adds an absent key with value
+        if (key < 0) {
+            throw std::invalid_argument("SkipList keys must be non-negative.");
+        }
+        if (contains(key)) {
+            throw std::invalid_argument("Key already exists in SkipList.");
+        }
+        if (static_cast<size_t>(key) >= tower.size()) {
+            size_t grown = std::max(static_cast<size_t>(key) + 1, tower.size() * 2);
+            tower.resize(grown, NO_TOWER);
+            height.resize(grown, 0);
+            present.resize(grown, 0);
+            values.resize(grown);
+        }
+        if (tower[key] == NO_TOWER) {
+            if (links.size() > UINT32_MAX - MAX_LEVEL) {
+                throw std::length_error("Too many keys for a SkipList.");
+            }
+            tower[key] = static_cast<uint32_t>(links.size());
+            height[key] = static_cast<uint8_t>(draw_height(key));
+            links.resize(links.size() + height[key], NONE);
+        }
+        values[key] = value;
+        present[key] = 1;
+        link(key);
+        current_size++;
+    }
+
+    void update(int key, const V &value) {
+        // moves a present key to value
+        if (!(contains(key))) {
+            throw std::out_of_range("Key not in SkipList.");
+        }
+        if (!comp(values[key], value) && !comp(value, values[key])) {
+            return;
+        }
+        unlink(key);
+        values[key] = value;
+        link(key);
+    }
+
+    void remove(int key) {
+        // removes key if present, keeping its tower for when it comes back
+        if (!(contains(key))) {
+            return;
+        }
+        unlink(key);
+        present[key] = 0;
+        current_size--;
+    }
+
+    void clear() {
+        // removes every key and tower
+        links.assign(MAX_LEVEL, NONE);
+        tower.clear();
+        height.clear();
+        present.clear();
+        values.clear();
+        levels = 1;
+        current_size = 0;
+    }
+
+    int first_after(const Position &position) const {
+        // first key after position in O(log N), -1 if there is none
+        return next(find(position, nullptr), 0);
+    }
+
+    int next(int key) const {
+        // key following a present key, -1 if it is the last
+        return next(key, 0);
+    }
+};
+
+#endif
@@ -0,0 +1,128 @@
+#ifndef THREADPOOL_HPP
+#define THREADPOOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+class ThreadPool {
+    // Fixed set of worker threads for data-parallel batches: parallel_for hands the indices of a batch out one at a
+    // time to the workers and the calling thread alike, and returns once all have run. Workers sleep between
+    // batches, so a pool costs nothing while idle and nothing is spawned per batch.
+private:
+    std::vector<std::thread> workers;
+    std::mutex batch_lock; // one batch at a time
+    std::mutex lock; // guards everything below except next
+    std::condition_variable wake; // workers wait here for a batch
+    std::condition_variable finished; // the caller waits here for the workers to leave the batch
+    std::function<void(size_t)> task; // body of the current batch
+    size_t count = 0; // indices in the current batch
+    std::atomic<size_t> next{0}; // next index to hand out
+    size_t active = 0; // workers still in the current batch
+    uint64_t generation = 0; // batches started
+    bool stopping = false;
+    std::exception_ptr error; // first exception thrown by the current batch
+
+    void work() {
+        // runs indices of the current batch until none are left
+        for (size_t i; (i = next.fetch_add(1)) < count;) {
+            try {
+                task(i);
+            } catch (...) {
+                std::lock_guard guard(lock);
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+        }
+    }
+
+    void worker() {
+        // waits for each batch, helps run it, then reports leaving it
+        uint64_t seen = 0;
+        while (true) {
+            {
+                std::unique_lock guard(lock);
+                wake.wait(guard, [&] { return stopping || generation != seen; });
+                if (stopping) {
+                    return;
+                }
+                seen = generation;
+            }
+            work();
+            std::lock_guard guard(lock);
+            if (--active == 0) {
+                finished.notify_one();
+            }
+        }
+    }
+
+public:
+    explicit ThreadPool(int threads) {
+        // threads in all, counting the thread that calls parallel_for
+        if (threads < 1) {
+            throw std::invalid_argument("A thread pool needs at least one thread.");
+        }
+        for (int t = 1; t < threads; t++) {
+            workers.emplace_back(&ThreadPool::worker, this);
+        }
+    }
+
+    ThreadPool(const ThreadPool &) = delete;
+
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    ~ThreadPool() {
+        // destructor
+        {
+            std::lock_guard guard(lock);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread &thread: workers) {
+            thread.join();
+        }
+    }
+
+    int size() const {
+        // threads in all, counting the caller
+        return static_cast<int>(workers.size()) + 1;
+    }
+
+    template<typename Body>
+    void parallel_for(size_t n, Body body) {
+        // calls body(i) for every i in [0, n) across the pool, rethrowing the first exception once all are done
+        if (workers.empty() || n <= 1) {
+            for (size_t i = 0; i < n; i++) {
+                body(i);
+            }
+            return;
+        }
+        std::lock_guard batch(batch_lock);
+        {
+            std::lock_guard guard(lock);
+            task = [&body](size_t i) { body(i); };
+            count = n;
+            next = 0;
+            active = workers.size();
+            error = nullptr;
+            generation++;
+        }
+        wake.notify_all();
+        work();
+        std::unique_lock guard(lock);
+        finished.wait(guard, [&] { return active == 0; });
+        task = nullptr;
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,171 @@
+#ifndef VERSIONTABLE_HPP
+#define VERSIONTABLE_HPP
+
+#include "Rope.hpp"
+#include "Arena.hpp"
+#include "Checkpoint.hpp"
+#include <vector>
+#include <string>
+#include <string_view>
+#include <span>
+#include <ctime>
+#include <cstddef>
+#include <stdexcept>
+
+struct VersionTable {
+    // Struct-of-arrays metadata of a file's versions, indexed by versionID. Whole-tree scans stream through
+    // contiguous arrays instead of chasing node pointers.
+    std::vector<int> parent; // parent versionID, -1 for root
+    std::vector<int> snapshot_ancestor; // nearest proper ancestor that is a snapshot, -1 if none
+    std::vector<int> child_count;
+    std::vector<time_t> created_timestamp;
+    std::vector<time_t> snapshot_timestamp; // -1 if not a snapshot
+    std::vector<unsigned char> snapshot; // 1 if snapshot
+    std::vector<unsigned char> rewritten; // 1 if content was replaced rather than appended to
+    std::vector<int> chain_length; // versions between this one and its nearest keyframe
+    std::vector<size_t> message_offset; // start of snapshot message in messages
+    std::vector<int> message_length;
+    std::string messages; // snapshot messages back to back
+    Arena<Rope> content; // pieces of content, shared with the parent where unchanged
+
+private:
+    // children of v are child_list[child_offset[v] .. child_offset[v + 1]), rebuilt after versions are added
+    mutable std::vector<int> child_offset;
+    mutable std::vector<int> child_list;
+    mutable bool children_valid = false;
+
+    void build_children() const {
+        // builds the CSR adjacency list from the parent array in O(V)
+        size_t n = parent.size();
+        child_offset.assign(n + 1, 0);
+        for (size_t v = 1; v < n; v++) {
+            child_offset[parent[v] + 1]++;
+        }
+        for (size_t v = 0; v < n; v++) {
+            child_offset[v + 1] += child_offset[v];
+        }
+        child_list.assign(n > 0 ? n - 1 : 0, 0);
+        std::vector<int> next(child_offset.begin(), child_offset.end() - 1);
+        for (size_t v = 1; v < n; v++) {
+            child_list[next[parent[v]]++] = static_cast<int>(v);
+        }
+        children_valid = true;
+    }
+
+public:
+    int add(const Rope &text, int parent_id, bool was_rewritten, time_t timestamp) {
+        // appends a version created at timestamp and returns its versionID
+        content.create(text);
+        parent.push_back(parent_id);
+        snapshot_ancestor.push_back(parent_id == -1 || snapshot[parent_id] ? parent_id : snapshot_ancestor[parent_id]);
+        child_count.push_back(0);
+        if (parent_id != -1) {
+            child_count[parent_id]++;
+        }
+        created_timestamp.push_back(timestamp);
+        snapshot_timestamp.push_back(static_cast<time_t>(-1));
+        snapshot.push_back(0);
+        rewritten.push_back(was_rewritten ? 1 : 0);
+        chain_length.push_back(0);
+        message_offset.push_back(0);
+        message_length.push_back(0);
+        children_valid = false;
+        return static_cast<int>(parent.size()) - 1;
+    }
+
+    size_t size() const {
+        // number of versions
+        return parent.size();
+    }
+
+    bool isSnapshot(int v) const {
+        // if version is a snapshot
+        return snapshot[v] != 0;
+    }
+
+    void set_snapshot(int v, const std::string &message, time_t timestamp) {
+        // marks version as snapshot with given message, an empty message leaves it mutable
+        snapshot_timestamp[v] = timestamp;
+        message_offset[v] = messages.size();
+        message_length[v] = static_cast<int>(message.size());
+        messages += message;
+        if (message.empty() || snapshot[v]) {
+            return;
+        }
+        snapshot[v] = 1;
+        if (child_count[v] == 0) {
+            return; // versions only branch from snapshots, so this is the usual case
+        }
+        // descendants skipping over v must now stop at it
+        std::vector<int> stack(children(v).begin(), children(v).end());
+        while (!stack.empty()) {
+            int current = stack.back();
+            stack.pop_back();
+            snapshot_ancestor[current] = v;
+            if (!snapshot[current]) {
+                for (int child: children(current)) {
+                    stack.push_back(child);
+                }
+            }
+        }
+    }
+
+    int snapshot_at_or_above(int v) const {
+        // v if it is a snapshot, else its nearest snapshot ancestor
+        return snapshot[v] ? v : snapshot_ancestor[v];
+    }
+
+    std::string_view message(int v) const {
+        // snapshot message of version
+        return std::string_view(messages).substr(message_offset[v], message_length[v]);
+    }
+
+    void save(ImageWriter &out) const {
+        // writes the metadata arrays to a checkpoint image, contents are saved separately as shared rope nodes
+        out.put_array(parent);
+        out.put_array(snapshot_ancestor);
+        out.put_array(child_count);
+        out.put_array(created_timestamp);
+        out.put_array(snapshot_timestamp);
+        out.put_array(snapshot);
+        out.put_array(rewritten);
+        out.put_array(chain_length);
+        out.put_array(message_offset);
+        out.put_array(message_length);
+        out.put_string(messages);
+    }
+
+    void load(ImageReader &in, size_t count) {
+        // reads the metadata arrays of count versions written by save, contents are added afterwards
+        in.get_array(parent, count);
+        in.get_array(snapshot_ancestor, count);
+        in.get_array(child_count, count);
+        in.get_array(created_timestamp, count);
+        in.get_array(snapshot_timestamp, count);
+        in.get_array(snapshot, count);
+        in.get_array(rewritten, count);
+        in.get_array(chain_length, count);
+        in.get_array(message_offset, count);
+        in.get_array(message_length, count);
+        messages = in.get_string();
+        for (size_t v = 0; v < count; v++) {
+            if (parent[v] < -1 || parent[v] >= static_cast<int>(v) || (v > 0) != (parent[v] != -1) ||
+                snapshot_ancestor[v] < -1 || snapshot_ancestor[v] >= static_cast<int>(v) ||
+                message_length[v] < 0 || message_offset[v] > messages.size() ||
+                static_cast<size_t>(message_length[v]) > messages.size() - message_offset[v]) {
+                throw std::runtime_error("Checkpoint image is truncated or corrupt.");
+            }
+        }
+        children_valid = false;
+    }
+
+    std::span<const int> children(int v) const {
+        // children of version in increasing versionID
+        if (!children_valid) {
+            build_children();
+        }
+        return std::span<const int>(child_list.data() + child_offset[v], child_offset[v + 1] - child_offset[v]);
+    }
+};
+
+#endif
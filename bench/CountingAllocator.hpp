@@ -0,0 +1,50 @@
+#ifndef COUNTINGALLOCATOR_HPP
+#define COUNTINGALLOCATOR_HPP
+
+// Replaces the global operator new and delete of a benchmark with malloc and free, counting the allocations made and
+// the bytes live and at their peak. Replacements cannot be inline, so include it from the one source file of a bench.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <malloc.h>
+#include <new>
+
+static size_t allocations = 0; // calls to operator new
+static size_t live_bytes = 0; // usable bytes of the blocks not yet deleted
+static size_t peak_bytes = 0; // highest live_bytes since the bench last reset it
+
+[[gnu::noinline]] static void release(void *p) {
+    // frees a block of operator new; out of line, so GCC never sees free() inlined next to a new expression and
+    // reports -Wmismatched-new-delete
+    live_bytes -= malloc_usable_size(p);
+    std::free(p);
+}
+
+void *operator new(size_t size) {
+    // counted malloc
+    void *p = std::malloc(size == 0 ? 1 : size);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    allocations++;
+    live_bytes += malloc_usable_size(p);
+    peak_bytes = std::max(peak_bytes, live_bytes);
+    return p;
+}
+
+void operator delete(void *p) noexcept {
+    // counted free
+    if (p != nullptr) {
+        release(p);
+    }
+}
+
+void operator delete(void *p, size_t) noexcept {
+    // counted free of a sized delete
+    if (p != nullptr) {
+        release(p);
+    }
+}
+
+#endif
@@ -0,0 +1,159 @@
+// COMPARE's diff algorithms on a generated corpus: source code full of braces and blank lines, a moved block, lines
+// drawn from a few distinct values, distinct lines, and an unrelated rewrite. For each pair of versions, the time
+// every algorithm takes and the lines its diff adds or removes, after checking histogram's occurrence cap.
+// usage: bench_algorithms [scale]
+
+#include "Diff.hpp"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+struct Sample {
+    const char *name;
+    std::string from;
+    std::string to;
+};
+
+std::string join(const std::vector<std::string> &lines) {
+    // text of lines, one per line
+    std::string text;
+    for (const std::string &line: lines) {
+        text += line;
+        text += '\n';
+    }
+    return text;
+}
+
+std::vector<std::string> source(std::mt19937 &rng, size_t lines) {
+    // C-like code: short functions whose closing braces, blank lines and common statements repeat throughout
+    static const char *common[] = {"    return 0;", "    }", "    break;", "    i++;", "        continue;"};
+    std::vector<std::string> code;
+    for (size_t f = 0; code.size() < lines; f++) {
+        code.push_back("int function_" + std::to_string(f) + "(int x) {");
+        for (int s = 3 + static_cast<int>(rng() % 6); s > 0; s--) {
+            if (rng() % 3 == 0) {
+                code.emplace_back(common[rng() % 5]);
+            } else {
+                code.push_back("    x = x * " + std::to_string(rng() % 1000) + " + " + std::to_string(f) + ";");
+            }
+        }
+        code.emplace_back("}");
+        code.emplace_back("");
+    }
+    return code;
+}
+
+void edit(std::mt19937 &rng, std::vector<std::string> &lines, size_t edits, const std::vector<std::string> &pool) {
+    // replaces, deletes or inserts edits random lines, new lines taken from pool
+    for (size_t e = 0; e < edits; e++) {
+        size_t at = rng() % lines.size();
+        switch (rng() % 3) {
+            case 0:
+                lines[at] = pool[rng() % pool.size()];
+                break;
+            case 1:
+                lines.erase(lines.begin() + at);
+                break;
+            default:
+                lines.insert(lines.begin() + at, pool[rng() % pool.size()]);
+                break;
+        }
+    }
+}
+
+std::vector<Sample> corpus(size_t scale) {
+    // pairs of versions, scale lines long
+    std::mt19937 rng(23);
+    std::vector<Sample> samples;
+    std::vector<std::string> braces = {"}", "", "    }", "{"};
+
+    std::vector<std::string> code = source(rng, scale);
+    std::vector<std::string> edited = code;
+    edit(rng, edited, scale / 250, braces);
+    edit(rng, edited, scale / 250, {"    x = edited(x);"});
+    samples.push_back({"code, scattered edits", join(code), join(edited)});
+
+    std::vector<std::string> moved = code;
+    size_t block = scale / 20;
+    std::vector<std::string> cut(moved.begin() + scale / 4, moved.begin() + scale / 4 + block);
+    moved.erase(moved.begin() + scale / 4, moved.begin() + scale / 4 + block);
+    moved.insert(moved.begin() + 3 * scale / 4, cut.begin(), cut.end());
+    samples.push_back({"code, moved block", join(code), join(moved)});
+
+    std::vector<std::string> values;
+    for (int v = 0; v < 16; v++) {
+        values.push_back("status=" + std::to_string(v));
+    }
+    std::vector<std::string> column(scale);
+    for (std::string &line: column) {
+        line = values[rng() % values.size()];
+    }
+    std::vector<std::string> column_edited = column;
+    edit(rng, column_edited, scale / 100, values);
+    samples.push_back({"16 distinct lines, 1% edited", join(column), join(column_edited)});
+
+    std::vector<std::string> distinct(scale);
+    for (size_t i = 0; i < scale; i++) {
+        distinct[i] = "record " + std::to_string(i) + " = " + std::to_string(rng());
+    }
+    std::vector<std::string> distinct_edited = distinct;
+    std::vector<std::string> fresh(scale / 100);
+    for (size_t i = 0; i < fresh.size(); i++) {
+        fresh[i] = "new record " + std::to_string(i);
+    }
+    edit(rng, distinct_edited, scale / 100, fresh);
+    samples.push_back({"distinct lines, 1% edited", join(distinct), join(distinct_edited)});
+
+    std::vector<std::string> rewrite = source(rng, scale / 10);
+    samples.push_back({"unrelated rewrite", join(std::vector<std::string>(code.begin(), code.begin() + scale / 10)),
+                       join(rewrite)});
+    return samples;
+}
+
+bool histogram_cap_holds() {
+    // A = [1, 0 x n], B = [0, 2]: at n = 64 the 0 anchors at its first occurrence in A, at n = 65 it may not and
+    // the range is diffed by Myers, which keeps a 0 from the middle
+    for (int n: {64, 65}) {
+        std::vector<int> A(n + 1, 0), B{0, 2};
+        A[0] = 1;
+        std::vector<char> deleted, inserted, myers_deleted, myers_inserted;
+        HistogramDiff(A, B, deleted, inserted).compare();
+        MyersDiff<int>(A, B, myers_deleted, myers_inserted).compare();
+        bool anchored = deleted[1] == 0;
+        if (n == 64 ? !anchored : deleted != myers_deleted || inserted != myers_inserted) {
+            std::printf("histogram anchoring wrong for a line occurring %d times\n", n);
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    size_t scale = argc > 1 ? std::stoull(argv[1]) : 100000;
+
+    if (!histogram_cap_holds()) {
+        return 1;
+    }
+
+    std::printf("%-30s %10s %22s %22s %22s\n", "sample", "lines", "myers", "patience", "histogram");
+    for (const Sample &sample: corpus(scale)) {
+        std::vector<std::string_view> from, to;
+        split_lines(sample.from, from);
+        split_lines(sample.to, to);
+        std::printf("%-30s %10zu", sample.name, from.size());
+        for (DiffAlgorithm algorithm: {DiffAlgorithm::Myers, DiffAlgorithm::Patience, DiffAlgorithm::Histogram}) {
+            auto start = std::chrono::steady_clock::now();
+            std::vector<DiffLine> lines = diff(from, to, algorithm);
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            size_t changed = 0;
+            for (const DiffLine &line: lines) {
+                changed += line.c != ' ';
+            }
+            std::printf(" %9.2f ms %7zu +/-", ms, changed);
+        }
+        std::printf("\n");
+    }
+    return 0;
+}
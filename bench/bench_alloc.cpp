@@ -0,0 +1,99 @@
+// Counts heap allocations and resident memory while building version trees, and compares the arena-backed
+// VersionTable with one new/delete per node and counts the allocations of a HashMap insert/remove cycle.
+// usage: bench_alloc [files] [versions_per_file]
+
+#include "FileSystem.hpp"
+#include "Memory.hpp"
+#include "CountingAllocator.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+template<typename Body>
+static double timed_ms(Body body) {
+    auto start = std::chrono::steady_clock::now();
+    body();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+int main(int argc, char *argv[]) {
+    int file_count = argc > 1 ? std::stoi(argv[1]) : 100;
+    int versions = argc > 2 ? std::stoi(argv[2]) : 1000;
+
+    // whole file system: allocations per version and RSS, then teardown
+    {
+        std::streambuf *console = std::cout.rdbuf(nullptr);
+        size_t rss_before = resident_memory_bytes();
+        size_t allocs_before = allocations;
+        auto *fs = new FileSystem();
+        double build_ms = timed_ms([&] {
+            for (int f = 0; f < file_count; f++) {
+                std::string name = "file" + std::to_string(f);
+                fs->create(name);
+                for (int v = 1; v < versions; v++) {
+                    fs->insert(name, "line " + std::to_string(v) + "\n");
+                    fs->snapshot(name, "v");
+                }
+            }
+        });
+        size_t allocs = allocations - allocs_before;
+        size_t rss_built = resident_memory_bytes();
+        double free_ms = timed_ms([&] { delete fs; });
+        size_t rss_freed = resident_memory_bytes();
+        std::cout.rdbuf(console);
+        std::printf("filesystem: %d files x %d versions, build %.1fms, %.2f allocations/version\n", file_count,
+                    versions, build_ms, static_cast<double>(allocs) / (file_count * versions));
+        std::printf("            rss before %zuKB, built %zuKB, after teardown %zuKB (teardown %.1fms)\n",
+                    rss_before / 1024, rss_built / 1024, rss_freed / 1024, free_ms);
+    }
+
+    // version creation: VersionTable arrays and content arena against one new per node
+    const int nodes = file_count * versions;
+    {
+        size_t allocs_before = allocations;
+        double ms = timed_ms([&] {
+            VersionTable table;
+            for (int i = 0; i < nodes; i++) {
+                table.add(Rope(), i - 1, false, 0);
+            }
+        });
+        std::printf("version table:    %d nodes, %.1fms, %zu allocations\n", nodes, ms, allocations - allocs_before);
+    }
+    {
+        struct Node {
+            Rope content;
+            int version_id;
+            Node *parent;
+        };
+        size_t allocs_before = allocations;
+        double ms = timed_ms([&] {
+            std::vector<Node *> owned;
+            owned.reserve(nodes);
+            for (int i = 0; i < nodes; i++) {
+                owned.push_back(new Node{Rope(), i, i > 0 ? owned.back() : nullptr});
+            }
+            for (Node *node: owned) {
+                delete node;
+            }
+        });
+        std::printf("node per new:     %d nodes, %.1fms, %zu allocations\n", nodes, ms, allocations - allocs_before);
+    }
+
+    // HashMap: flat slot arrays, measured as a whole insert/remove cycle
+    {
+        size_t allocs_before = allocations;
+        double ms = timed_ms([&] {
+            HashMap<int, int> map;
+            for (int i = 0; i < nodes; i++) {
+                map.insert(i, i);
+            }
+            for (int i = 0; i < nodes; i++) {
+                map.remove(i);
+            }
+        });
+        std::printf("hashmap:          %d keys, %.1fms, %zu allocations\n", nodes, ms, allocations - allocs_before);
+    }
+    return 0;
+}
@@ -0,0 +1,50 @@
+// Log-style workload: INSERT a line into a snapshotted version, then snapshot, many times.
+// Compares the rope-backed File with the previous layout, which copied the parent's content on every INSERT.
+// usage: bench_append [appends] [baseline_limit]
+
+#include "File.hpp"
+#include <chrono>
+#include <cstdio>
+#include <sstream>
+#include <string>
+
+int main(int argc, char *argv[]) {
+    int appends = argc > 1 ? std::stoi(argv[1]) : 100000;
+    int baseline_limit = argc > 2 ? std::stoi(argv[2]) : 20000; // the old layout needs O(appends^2) bytes
+    const std::string line = "2026-01-01 12:00:00 INFO request served in 12ms\n";
+
+    BlobStore store;
+    File file("log.txt", "", store);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < appends; i++) {
+        file.newversion(file.content(file.active_version) + Rope(store, line), file.active_version, file.total_versions);
+        file.snapshot("append");
+    }
+    auto end = std::chrono::steady_clock::now();
+    double rope_us = std::chrono::duration<double, std::micro>(end - start).count() / appends;
+
+    std::ostringstream out;
+    start = std::chrono::steady_clock::now();
+    out << file.content(file.active_version);
+    end = std::chrono::steady_clock::now();
+    double read_ms = std::chrono::duration<double, std::milli>(end - start).count();
+
+    // previous layout: every new version owned active_version->content + content
+    int baseline_appends = appends < baseline_limit ? appends : baseline_limit;
+    std::string previous;
+    size_t baseline_bytes = 0;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < baseline_appends; i++) {
+        std::string next = previous + line;
+        baseline_bytes += next.size();
+        previous = std::move(next);
+    }
+    end = std::chrono::steady_clock::now();
+    double baseline_us = std::chrono::duration<double, std::micro>(end - start).count() / baseline_appends;
+
+    std::printf("rope:     appends=%d insert=%.3fus/op content bytes=%zu rope nodes=%zu read=%.2fms (%zu bytes)\n",
+                appends, rope_us, store.bytes_stored(), Rope::live_nodes(), read_ms, out.str().size());
+    std::printf("baseline: appends=%d insert=%.3fus/op content bytes=%zu\n", baseline_appends, baseline_us,
+                baseline_bytes);
+    return 0;
+}
@@ -0,0 +1,90 @@
+// BIGGEST TREES on CountBuckets against the previous IndexedHeap: the update every new version makes, BIGGEST TREES
+// k, and the full listing, with new versions spread uniformly and skewed onto a few files.
+// usage: bench_biggest [files] [versions] [queries]
+
+#include "CountBuckets.hpp"
+#include "Heap.hpp"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+using VersionHeap = IndexedHeap<int, int, greater<int>, DenseIndex>;
+
+template<typename Body>
+static double ns_per_op(size_t ops, Body body) {
+    auto start = std::chrono::steady_clock::now();
+    body();
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / ops;
+}
+
+void run(const char *shape, int files, const std::vector<int> &grown, size_t queries) {
+    // every file starts with one version, then each entry of grown gets a new one
+    VersionHeap heap;
+    CountBuckets buckets;
+    for (int id = 0; id < files; id++) {
+        heap.push(id, 1);
+        buckets.insert(id, 1);
+    }
+    double heap_update = ns_per_op(grown.size(), [&] {
+        for (int id: grown) {
+            heap.update(id, heap.get(id) + 1);
+        }
+    });
+    double bucket_update = ns_per_op(grown.size(), [&] {
+        for (int id: grown) {
+            buckets.increment(id);
+        }
+    });
+
+    long long sink = 0;
+    double heap_top = ns_per_op(queries, [&] {
+        for (size_t q = 0; q < queries; q++) {
+            sink += heap.topk(10).back().value;
+        }
+    });
+    double bucket_top = ns_per_op(queries, [&] {
+        for (size_t q = 0; q < queries; q++) {
+            buckets.for_each([&](int, int count) { sink += count; }, 10);
+        }
+    });
+
+    // the previous unbounded BIGGEST TREES popped every file and built the heap again
+    double heap_all = ns_per_op(1, [&] {
+        std::vector<Element<int, int> > popped;
+        while (!(heap.empty())) {
+            popped.push_back(heap.top());
+            sink += heap.top().value;
+            heap.pop();
+        }
+        heap.build(popped);
+    });
+    double bucket_all = ns_per_op(1, [&] {
+        buckets.for_each([&](int, int count) { sink += count; });
+    });
+
+    std::printf("%s, %d files, %zu new versions\n", shape, files, grown.size());
+    std::printf("  %-12s update=%7.1f ns  top 10=%8.1f ns  all=%8.2f ms\n", "IndexedHeap", heap_update, heap_top,
+                heap_all / 1e6);
+    std::printf("  %-12s update=%7.1f ns  top 10=%8.1f ns  all=%8.2f ms%s\n", "CountBuckets", bucket_update,
+                bucket_top, bucket_all / 1e6, sink == 0 ? " (empty)" : "");
+}
+
+int main(int argc, char *argv[]) {
+    int files = argc > 1 ? std::stoi(argv[1]) : 1000000;
+    size_t versions = argc > 2 ? std::stoull(argv[2]) : 4000000;
+    size_t queries = argc > 3 ? std::stoull(argv[3]) : 100000;
+
+    std::mt19937 rng(13);
+    std::vector<int> uniform(versions), skewed(versions);
+    for (size_t i = 0; i < versions; i++) {
+        uniform[i] = static_cast<int>(rng() % files);
+        // cubing a uniform draw piles the new versions onto the first files
+        double u = std::generate_canonical<double, 32>(rng);
+        skewed[i] = static_cast<int>(u * u * u * (files - 1));
+    }
+    run("uniform", files, uniform, queries);
+    run("skewed", files, skewed, queries);
+    return 0;
+}
@@ -0,0 +1,64 @@
+// Skewed READ workload over many large versions: most reads hit a small hot set of files.
+// Compares keeping every content in memory with a cold store under a memory budget.
+// usage: bench_cache [files] [bytes_per_file] [budget_bytes] [reads] [directory]
+
+#include "FileSystem.hpp"
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+
+void run(const char *label, int files, size_t bytes_per_file, int reads, const std::string &directory,
+         size_t budget) {
+    std::streambuf *console = std::cout.rdbuf(nullptr);
+    FileSystem fs;
+    if (!directory.empty()) {
+        fs.enable_cold_store(directory, budget);
+    }
+    for (int f = 0; f < files; f++) {
+        std::string name = "file" + std::to_string(f);
+        fs.create(name);
+        fs.update(name, std::string(bytes_per_file, static_cast<char>('a' + f % 26)) + std::to_string(f));
+        fs.maintain();
+    }
+    std::mt19937 rng(7);
+    int hot = files / 20 > 0 ? files / 20 : 1; // 5% of the files get 95% of the reads
+    size_t read_bytes = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < reads; i++) {
+        int f = rng() % 20 != 0 ? rng() % hot : rng() % files;
+        std::ostringstream out;
+        out << fs.read("file" + std::to_string(f));
+        read_bytes += out.str().size();
+        fs.maintain();
+    }
+    double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / reads;
+    std::stringstream stats;
+    std::cout.rdbuf(stats.rdbuf());
+    fs.stats();
+    std::cout.rdbuf(console);
+    std::printf("%s: read=%.2fus/op (%zu bytes read) resident memory=%.1f MB\n", label, us, read_bytes,
+                resident_memory_bytes() / 1048576.0);
+    std::string line;
+    while (std::getline(stats, line)) {
+        if (line.starts_with("Resident Bytes") || line.starts_with("Cache")) {
+            std::printf("  %s\n", line.c_str());
+        }
+    }
+}
+
+int main(int argc, char *argv[]) {
+    int files = argc > 1 ? std::stoi(argv[1]) : 2000;
+    size_t bytes_per_file = argc > 2 ? std::stoull(argv[2]) : 64 * 1024;
+    size_t budget = argc > 3 ? std::stoull(argv[3]) : 16 << 20;
+    int reads = argc > 4 ? std::stoi(argv[4]) : 20000;
+    std::string directory = argc > 5 ? argv[5] : "bench_cache.cold";
+
+    // the cold store runs first so its resident memory is not inflated by the in-memory run
+    run("cold store", files, bytes_per_file, reads, directory, budget);
+    run("in memory ", files, bytes_per_file, reads, "", 0);
+    std::filesystem::remove_all(directory);
+    return 0;
+}
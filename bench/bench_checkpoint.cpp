@@ -0,0 +1,83 @@
+// Startup time of a large file system: replaying its journal against loading its memory mapped checkpoint.
+// Every file gets versions_per_file versions through alternating INSERT and SNAPSHOT.
+// usage: bench_checkpoint [files] [versions_per_file] [directory]
+
+#include "FileSystem.hpp"
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char *argv[]) {
+    int files = argc > 1 ? std::stoi(argv[1]) : 100000;
+    int versions_per_file = argc > 2 ? std::stoi(argv[2]) : 100;
+    std::string directory = argc > 3 ? argv[3] : ".";
+    std::string journal_path = directory + "/bench_checkpoint.log";
+    std::string image_path = directory + "/bench_checkpoint.img";
+    std::remove(journal_path.c_str());
+    std::remove(image_path.c_str());
+    std::streambuf *console = std::cout.rdbuf(nullptr);
+
+    double build_s, checkpoint_s;
+    {
+        FileSystem fs;
+        Journal journal(journal_path, FsyncPolicy::Group, 4096);
+        fs.attach_journal(&journal);
+        auto start = std::chrono::steady_clock::now();
+        for (int f = 0; f < files; f++) {
+            std::string name = "file" + std::to_string(f);
+            fs.create(name);
+            for (int v = 1; v < versions_per_file; v++) {
+                fs.insert(name, "entry " + std::to_string(v) + " of " + name + "\n");
+                fs.snapshot(name, "v" + std::to_string(v));
+            }
+        }
+        journal.sync();
+        build_s = seconds_since(start);
+        // the journal is kept as is for the replay below, so the checkpoint is written without it
+        fs.attach_journal(nullptr);
+        start = std::chrono::steady_clock::now();
+        fs.checkpoint(image_path);
+        checkpoint_s = seconds_since(start);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    size_t replayed;
+    {
+        FileSystem fs;
+        replayed = fs.replay(Journal::load(journal_path));
+    }
+    double replay_s = seconds_since(start);
+
+    start = std::chrono::steady_clock::now();
+    FileSystem fs;
+    fs.load_checkpoint(image_path);
+    double load_s = seconds_since(start);
+    size_t load_rss = resident_memory_bytes();
+
+    start = std::chrono::steady_clock::now();
+    std::ostringstream out;
+    for (int f = 0; f < files; f++) {
+        out << fs.read("file" + std::to_string(f));
+    }
+    double read_s = seconds_since(start);
+    std::cout.rdbuf(console);
+
+    std::printf("files=%d versions=%lld\n", files, static_cast<long long>(files) * versions_per_file);
+    std::printf("build:          %8.3f s (journal %.1f MB)\n", build_s,
+                std::filesystem::file_size(journal_path) / 1048576.0);
+    std::printf("checkpoint:     %8.3f s (image %.1f MB)\n", checkpoint_s,
+                std::filesystem::file_size(image_path) / 1048576.0);
+    std::printf("journal replay: %8.3f s (%zu records)\n", replay_s, replayed);
+    std::printf("checkpoint load:%8.3f s (resident %.1f MB)\n", load_s, load_rss / 1048576.0);
+    std::printf("first READ of every file from the mapping: %.3f s (%zu bytes)\n", read_s, out.str().size());
+    std::remove(journal_path.c_str());
+    std::remove(image_path.c_str());
+    return 0;
+}
@@ -0,0 +1,132 @@
+// Compression ratio and throughput of the in-tree LZ codec on typical version contents, and resident bytes of a
+// file system whose snapshots go cold and get compressed.
+// usage: bench_compress [bytes] [files]
+
+#include "FileSystem.hpp"
+#include "Lz.hpp"
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+
+std::string log_text(size_t bytes) {
+    std::string out;
+    for (size_t i = 0; out.size() < bytes; i++) {
+        out += "2026-01-01 12:" + std::to_string(10 + i / 60 % 50) + ":" + std::to_string(10 + i % 50) +
+                " INFO request " + std::to_string(i * 7919 % 100000) + " served in " + std::to_string(i % 97) +
+                "ms\n";
+    }
+    out.resize(bytes);
+    return out;
+}
+
+std::string word_text(size_t bytes) {
+    // words drawn from a small vocabulary with a skewed distribution
+    static const char *words[] = {
+        "the", "version", "file", "snapshot", "content", "of", "and", "a", "tree", "to", "is", "rollback", "in",
+        "history", "message", "parent", "node", "with", "for", "active"
+    };
+    std::mt19937 rng(1);
+    std::string out;
+    while (out.size() < bytes) {
+        int w = static_cast<int>(rng() % 20);
+        out += words[w * w / 20];
+        out += rng() % 12 == 0 ? '\n' : ' ';
+    }
+    out.resize(bytes);
+    return out;
+}
+
+std::string random_text(size_t bytes) {
+    std::mt19937 rng(2);
+    std::string out(bytes, '\0');
+    for (char &c: out) {
+        c = static_cast<char>(rng());
+    }
+    return out;
+}
+
+void measure(const char *label, const std::string &text) {
+    // prints ratio and throughput of compressing and decompressing text
+    int rounds = 0;
+    std::string packed;
+    auto start = std::chrono::steady_clock::now();
+    double elapsed = 0;
+    while (elapsed < 0.3) {
+        packed = lz_compress(text);
+        rounds++;
+        elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    double compress_mbs = text.size() * rounds / elapsed / 1048576.0;
+    rounds = 0;
+    size_t check = 0;
+    start = std::chrono::steady_clock::now();
+    elapsed = 0;
+    while (elapsed < 0.3) {
+        check += lz_decompress(packed, text.size()).size();
+        rounds++;
+        elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    double decompress_mbs = text.size() * rounds / elapsed / 1048576.0;
+    std::printf("%-8s ratio=%6.2f compress=%8.1f MB/s decompress=%8.1f MB/s%s\n", label,
+                static_cast<double>(text.size()) / packed.size(), compress_mbs, decompress_mbs,
+                check == text.size() * rounds ? "" : " (size mismatch)");
+}
+
+int main(int argc, char *argv[]) {
+    size_t bytes = argc > 1 ? std::stoull(argv[1]) : 1 << 20;
+    int files = argc > 2 ? std::stoi(argv[2]) : 200;
+
+    measure("log", log_text(bytes));
+    measure("words", word_text(bytes));
+    measure("random", random_text(bytes));
+
+    // every file gets a few snapshots of log content, then eight commands without reads let them go cold
+    std::streambuf *console = std::cout.rdbuf(nullptr);
+    FileSystem fs;
+    fs.enable_compression(8);
+    for (int f = 0; f < files; f++) {
+        std::string name = "file" + std::to_string(f);
+        fs.create(name);
+        for (int v = 0; v < 4; v++) {
+            fs.update(name, log_text(16384 + 997 * (f * 4 + v)));
+            fs.snapshot(name, "v" + std::to_string(v));
+        }
+    }
+    std::stringstream before;
+    std::cout.rdbuf(before.rdbuf());
+    fs.stats();
+    for (int i = 0; i < 8; i++) {
+        fs.maintain();
+    }
+    std::stringstream after;
+    std::cout.rdbuf(after.rdbuf());
+    fs.stats();
+    std::cout.rdbuf(nullptr);
+    auto start = std::chrono::steady_clock::now();
+    size_t read_bytes = 0;
+    for (int f = 0; f < files; f++) {
+        std::ostringstream out;
+        out << fs.read("file" + std::to_string(f));
+        read_bytes += out.str().size();
+    }
+    double read_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout.rdbuf(console);
+
+    auto print = [](const char *label, std::stringstream &stats) {
+        std::string line;
+        std::printf("%s:", label);
+        while (std::getline(stats, line)) {
+            if (line.starts_with("Resident Bytes") || line.starts_with("Compress")) {
+                std::printf(" [%s]", line.c_str());
+            }
+        }
+        std::printf("\n");
+    };
+    print("hot ", before);
+    print("cold", after);
+    std::printf("READ of every file after going cold: %.2f ms (%zu bytes decompressed)\n", read_ms, read_bytes);
+    return 0;
+}
@@ -0,0 +1,112 @@
+// Throughput of the sharded ConcurrentHashMap against one HashMap behind a single reader-writer lock, from 1 to N
+// threads, with a read-heavy (95% lookups) and a write-heavy (50% inserts/removes) mix on file names.
+// usage: bench_concurrent [max_threads] [keys] [operations]
+
+#include "ConcurrentHashMap.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+template<typename K, typename V>
+class GlobalLockHashMap {
+    // baseline: the whole HashMap behind one lock
+    mutable std::shared_mutex lock;
+    HashMap<K, V> map;
+
+public:
+    bool count(const K &key) const {
+        std::shared_lock guard(lock);
+        return map.count(key);
+    }
+
+    V get(const K &key) const {
+        std::shared_lock guard(lock);
+        return map.get(key);
+    }
+
+    bool insert_new(const K &key, const V &value) {
+        std::unique_lock guard(lock);
+        if (map.count(key)) {
+            return false;
+        }
+        map.insert(key, value);
+        return true;
+    }
+
+    void remove(const K &key) {
+        std::unique_lock guard(lock);
+        map.remove(key);
+    }
+};
+
+template<typename Map>
+double run(int threads, int write_percent, const std::vector<std::string> &names,
+           const std::vector<std::string> &extra, size_t operations) {
+    // returns millions of operations per second over all threads
+    Map map;
+    for (size_t i = 0; i < names.size(); i++) {
+        map.insert_new(names[i], static_cast<int>(i));
+    }
+    std::vector<std::thread> workers;
+    std::vector<size_t> hits(threads, 0);
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t] {
+            std::mt19937 rng(t + 1);
+            size_t local = 0;
+            for (size_t op = 0; op < operations / threads; op++) {
+                if (static_cast<int>(rng() % 100) < write_percent) {
+                    // CREATE-like insert of a new name, or removal of one
+                    const std::string &name = extra[rng() % extra.size()];
+                    if (rng() % 2 == 0) {
+                        local += map.insert_new(name, t);
+                    } else {
+                        map.remove(name);
+                    }
+                } else {
+                    // READ-like lookup: count, then get
+                    const std::string &name = names[rng() % names.size()];
+                    if (map.count(name)) {
+                        local += map.get(name);
+                    }
+                }
+            }
+            hits[t] = local;
+        });
+    }
+    for (std::thread &worker: workers) {
+        worker.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return operations / seconds / 1e6;
+}
+
+int main(int argc, char *argv[]) {
+    int hardware = static_cast<int>(std::thread::hardware_concurrency());
+    int max_threads = argc > 1 ? std::stoi(argv[1]) : std::max(hardware, 4);
+    size_t keys = argc > 2 ? std::stoull(argv[2]) : 100000;
+    size_t operations = argc > 3 ? std::stoull(argv[3]) : 4000000;
+
+    std::vector<std::string> names, extra;
+    for (size_t i = 0; i < keys; i++) {
+        names.push_back("file" + std::to_string(i) + ".txt");
+        extra.push_back("new" + std::to_string(i) + ".txt");
+    }
+    std::printf("%d hardware threads, %zu keys, %zu operations per run\n", hardware, keys, operations);
+    for (int write_percent: {5, 50}) {
+        std::printf("%s mix (%d%% writes)\n", write_percent < 50 ? "read-heavy" : "write-heavy", write_percent);
+        for (int threads = 1; threads <= max_threads; threads *= 2) {
+            double sharded = run<ConcurrentHashMap<std::string, int> >(threads, write_percent, names, extra,
+                                                                       operations);
+            double global = run<GlobalLockHashMap<std::string, int> >(threads, write_percent, names, extra,
+                                                                      operations);
+            std::printf("  %2d threads: sharded %7.2f Mops/s, single lock %7.2f Mops/s\n", threads, sharded, global);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,58 @@
+// Tail latency of CREATE while the file table grows, and of the same inserts into a bare HashMap with incremental
+// resizing on and off.
+// usage: bench_create [files]
+
+#include "FileSystem.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+void report(const char *label, std::vector<double> &latencies) {
+    // prints percentiles of per-operation latencies in nanoseconds
+    std::sort(latencies.begin(), latencies.end());
+    auto at = [&](double quantile) {
+        return latencies[static_cast<size_t>(quantile * (latencies.size() - 1))];
+    };
+    std::printf("%-22s p50=%8.0f p99=%8.0f p999=%9.0f max=%11.0f ns\n", label, at(0.5), at(0.99), at(0.999),
+                latencies.back());
+}
+
+template<typename Body>
+std::vector<double> per_op(int ops, Body body) {
+    // times body(i) for every i in [0, ops)
+    std::vector<double> latencies(ops);
+    for (int i = 0; i < ops; i++) {
+        auto start = std::chrono::steady_clock::now();
+        body(i);
+        latencies[i] = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    }
+    return latencies;
+}
+
+int main(int argc, char *argv[]) {
+    int files = argc > 1 ? std::stoi(argv[1]) : 1000000;
+    std::vector<std::string> names;
+    for (int i = 0; i < files; i++) {
+        names.push_back("file" + std::to_string(i) + ".txt");
+    }
+
+    for (bool incremental: {true, false}) {
+        HashMap<std::string, File *> map;
+        map.incremental_resize(incremental);
+        std::vector<double> latencies = per_op(files, [&](int i) { map.insert(names[i], nullptr); });
+        report(incremental ? "HashMap incremental" : "HashMap all at once", latencies);
+    }
+
+    std::streambuf *console = std::cout.rdbuf(nullptr);
+    std::vector<double> latencies;
+    {
+        FileSystem fs;
+        latencies = per_op(files, [&](int i) { fs.create(names[i]); });
+    }
+    std::cout.rdbuf(console);
+    report("CREATE", latencies);
+    return 0;
+}
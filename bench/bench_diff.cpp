@@ -0,0 +1,185 @@
+// COMPARE's diff on versions of growing size and edit distance: the linear-space Myers diff against the previous
+// breadth-first search over an (N+1)x(M+1) parent matrix, with the time and peak heap each takes. Then whole texts of
+// mostly identical versions, split and diffed as COMPARE does, against splitting them into strings with std::getline
+// and diffing those.
+// usage: bench_diff [max lines]
+
+#include "Diff.hpp"
+#include "CountingAllocator.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <queue>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+size_t legacy_edits(const std::vector<std::string> &A, const std::vector<std::string> &B) {
+    // the previous diff, reduced to its search: breadth-first from (0, 0), following every snake, a parent for
+    // every cell, and the edits counted by walking the parents back from (N, M)
+    int n = static_cast<int>(B.size());
+    int m = static_cast<int>(A.size());
+    std::vector<std::vector<std::pair<int, int> > > parent(n + 1, std::vector<std::pair<int, int> >(m + 1, {-1, -1}));
+    std::queue<std::pair<int, int> > q;
+    auto reach = [&](int i, int j, int from_i, int from_j) {
+        // marks (i, j) and the snake after it, queueing every cell on the way
+        if (parent[i][j].first != -1 || (i == 0 && j == 0)) {
+            return;
+        }
+        parent[i][j] = {from_i, from_j};
+        q.push({i, j});
+        while (i < n && j < m && A[j] == B[i] && parent[i + 1][j + 1].first == -1) {
+            parent[i + 1][j + 1] = {i, j};
+            q.push({++i, ++j});
+        }
+    };
+    q.push({0, 0});
+    for (int i = 0; i < n && i < m && A[i] == B[i]; i++) {
+        parent[i + 1][i + 1] = {i, i};
+        q.push({i + 1, i + 1});
+    }
+    while (!(q.empty()) && parent[n][m].first == -1 && !(n == 0 && m == 0)) {
+        std::pair<int, int> c = q.front();
+        q.pop();
+        if (c.second < m) {
+            reach(c.first, c.second + 1, c.first, c.second);
+        }
+        if (c.first < n) {
+            reach(c.first + 1, c.second, c.first, c.second);
+        }
+    }
+    size_t edits = 0;
+    for (std::pair<int, int> c = {n, m}; c.first > 0 || c.second > 0; c = parent[c.first][c.second]) {
+        std::pair<int, int> p = parent[c.first][c.second];
+        edits += (c.first - p.first) + (c.second - p.second) == 1;
+    }
+    return edits;
+}
+
+size_t edits(const std::vector<DiffLine> &lines) {
+    // lines added or removed
+    size_t count = 0;
+    for (const DiffLine &l: lines) {
+        count += l.c != ' ';
+    }
+    return count;
+}
+
+std::vector<DiffLine> string_diff(const std::string &A, const std::string &B) {
+    // the previous COMPARE path: every line copied into a std::string, then diffed comparing strings
+    std::vector<std::string> a_lines, b_lines;
+    for (auto [text, lines]: {std::pair{&A, &a_lines}, std::pair{&B, &b_lines}}) {
+        std::istringstream iss(*text);
+        std::string line;
+        while (std::getline(iss, line)) {
+            lines->push_back(line);
+        }
+    }
+    std::vector<char> deleted, inserted;
+    MyersDiff<std::string>(a_lines, b_lines, deleted, inserted);
+    std::vector<DiffLine> difflines;
+    size_t i = 0;
+    size_t j = 0;
+    while (i < a_lines.size() || j < b_lines.size()) {
+        if (i < a_lines.size() && deleted[i]) {
+            difflines.emplace_back(2, a_lines[i++]);
+        } else if (j < b_lines.size() && inserted[j]) {
+            difflines.emplace_back(1, b_lines[j++]);
+        } else {
+            difflines.emplace_back(0, b_lines[j]);
+            i++;
+            j++;
+        }
+    }
+    return difflines;
+}
+
+template<typename Body>
+static double milliseconds(Body body) {
+    auto start = std::chrono::steady_clock::now();
+    body();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char *argv[]) {
+    size_t max_lines = argc > 1 ? std::stoull(argv[1]) : 100000;
+
+    std::mt19937 rng(21);
+    std::printf("%8s %7s %12s %12s %12s %12s %7s\n", "lines", "edits", "myers ms", "myers peak", "previous ms",
+                "prev peak", "script");
+    for (size_t lines: {1000, 4000, 20000, 100000, 1000000}) {
+        if (lines > max_lines) {
+            break;
+        }
+        for (size_t changes: {10, 100, 1000}) {
+            // changes random lines of a file of distinct lines replaced, deleted or inserted
+            std::vector<std::string> A(lines);
+            for (size_t i = 0; i < lines; i++) {
+                A[i] = "line " + std::to_string(i) + " of the old version";
+            }
+            std::vector<std::string> B = A;
+            for (size_t c = 0; c < changes; c++) {
+                size_t at = rng() % B.size();
+                switch (rng() % 3) {
+                    case 0:
+                        B[at] = "changed line " + std::to_string(c);
+                        break;
+                    case 1:
+                        B.erase(B.begin() + at);
+                        break;
+                    default:
+                        B.insert(B.begin() + at, "inserted line " + std::to_string(c));
+                        break;
+                }
+            }
+
+            size_t script = 0;
+            peak_bytes = live_bytes;
+            size_t base = live_bytes;
+            double myers = milliseconds([&] { script = edits(diff(A, B)); });
+            size_t myers_peak = peak_bytes - base;
+
+            // the parent matrix takes 8 bytes a cell, so the previous diff is only run while it stays under 1 GiB
+            if (static_cast<double>(A.size() + 1) * (B.size() + 1) * 8 <= 1024.0 * 1024 * 1024) {
+                size_t legacy_script = 0;
+                peak_bytes = live_bytes;
+                double legacy = milliseconds([&] { legacy_script = legacy_edits(A, B); });
+                std::printf("%8zu %7zu %12.2f %11.1fM %12.2f %11.1fM %7zu%s\n", lines, changes, myers,
+                            myers_peak / 1048576.0, legacy, (peak_bytes - base) / 1048576.0, script,
+                            legacy_script == script ? "" : " (scripts differ)");
+            } else {
+                std::printf("%8zu %7zu %12.2f %11.1fM %12s %12s %7zu\n", lines, changes, myers,
+                            myers_peak / 1048576.0, "-", "-", script);
+            }
+        }
+    }
+
+    std::printf("\n%8s %7s %9s %14s %14s\n", "lines", "edits", "text MB", "strings ms", "interned ms");
+    for (size_t lines: {10000, 100000, 1000000}) {
+        if (lines > max_lines) {
+            break;
+        }
+        std::string A;
+        for (size_t i = 0; i < lines; i++) {
+            A += "    value = compute(value, " + std::to_string(i % 97) + "); // line " + std::to_string(i) + "\n";
+        }
+        for (size_t changes: {1, 10, 100}) {
+            // changes lines rewritten in place, spread over the text
+            std::string B = A;
+            for (size_t c = 0; c < changes; c++) {
+                size_t at = B.find('\n', rng() % B.size());
+                if (at != std::string::npos && at > 0) {
+                    B[at - 1] = 'X';
+                }
+            }
+            size_t strings_script = 0, interned_script = 0;
+            double strings = milliseconds([&] { strings_script = edits(string_diff(A, B)); });
+            double interned = milliseconds([&] { interned_script = edits(diff(std::string_view(A), B)); });
+            std::printf("%8zu %7zu %9.1f %14.2f %14.2f%s\n", lines, changes, A.size() / 1048576.0, strings, interned,
+                        strings_script == interned_script ? "" : " (scripts differ)");
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,204 @@
+// Hash quality and throughput of hash_bytes/hash_int against the previous djb2 and identity hashes and std::hash,
+// and HashMap lookups by std::string_view against building a std::string first.
+// usage: bench_hash [keys] [lookups]
+
+#include "HashMap.hpp"
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+volatile uint64_t hash_sink; // keeps the hashing loops from being optimized away
+
+uint64_t djb2(std::string_view text) {
+    // previous string hash
+    unsigned long hash = 5381;
+    for (char c: text) {
+        hash = ((hash << 5) + hash) + c;
+    }
+    return static_cast<unsigned int>(hash);
+}
+
+uint64_t identity(uint64_t key) {
+    // previous int hash
+    return static_cast<unsigned int>(key);
+}
+
+uint64_t fast_bytes(std::string_view text) {
+    return hash_bytes(text.data(), text.size());
+}
+
+uint64_t std_bytes(std::string_view text) {
+    return std::hash<std::string_view>()(text);
+}
+
+uint64_t std_int(uint64_t key) {
+    return std::hash<uint64_t>()(key);
+}
+
+void spread(const char *label, const std::vector<uint64_t> &hashes) {
+    // places the hashes into as many power-of-two buckets by their low bits, the way a HashMap picks a bucket
+    size_t buckets = std::bit_floor(hashes.size());
+    std::vector<int> load(buckets, 0);
+    for (uint64_t h: hashes) {
+        load[h & (buckets - 1)]++;
+    }
+    size_t empty = 0;
+    int longest = 0;
+    for (int l: load) {
+        empty += l == 0;
+        longest = std::max(longest, l);
+    }
+    // a random function leaves about exp(-keys/buckets) of the buckets empty
+    double ideal = std::exp(-static_cast<double>(hashes.size()) / buckets);
+    std::printf("    %-10s empty buckets=%5.1f%% (random %4.1f%%) longest chain=%d\n", label,
+                100.0 * empty / buckets, 100.0 * ideal, longest);
+}
+
+template<typename Key, typename Hash>
+std::vector<uint64_t> hash_all(const std::vector<Key> &keys, Hash hash) {
+    std::vector<uint64_t> hashes;
+    for (const Key &key: keys) {
+        hashes.push_back(hash(key));
+    }
+    return hashes;
+}
+
+void quality(size_t n) {
+    // key sets with the regular structure real file names and indices have
+    std::vector<std::string> names, paths;
+    std::vector<uint64_t> sequential, strided;
+    for (size_t i = 0; i < n; i++) {
+        names.push_back("file" + std::to_string(i) + ".txt");
+        paths.push_back("src/module" + std::to_string(i % 100) + "/part" + std::to_string(i / 100) + ".cpp");
+        sequential.push_back(i);
+        strided.push_back(i * 4096);
+    }
+    std::printf("bucket spread of %zu keys\n", n);
+    std::printf("  file names\n");
+    spread("djb2", hash_all(names, djb2));
+    spread("hash_bytes", hash_all(names, fast_bytes));
+    spread("std::hash", hash_all(names, std_bytes));
+    std::printf("  paths\n");
+    spread("djb2", hash_all(paths, djb2));
+    spread("hash_bytes", hash_all(paths, fast_bytes));
+    spread("std::hash", hash_all(paths, std_bytes));
+    std::printf("  sequential ints\n");
+    spread("identity", hash_all(sequential, identity));
+    spread("hash_int", hash_all(sequential, hash_int));
+    spread("std::hash", hash_all(sequential, std_int));
+    std::printf("  ints strided by 4096\n");
+    spread("identity", hash_all(strided, identity));
+    spread("hash_int", hash_all(strided, hash_int));
+    spread("std::hash", hash_all(strided, std_int));
+}
+
+template<typename Hash>
+void avalanche(const char *label, Hash hash, size_t length, int output_bits) {
+    // flips every input bit of random keys and reports how far the chance of each output bit flipping is from 1/2
+    std::mt19937_64 rng(11);
+    const int trials = 2000;
+    std::vector<int> flips(output_bits, 0);
+    std::string key(length, '\0');
+    for (int t = 0; t < trials; t++) {
+        for (char &c: key) {
+            c = static_cast<char>(rng());
+        }
+        uint64_t base = hash(key);
+        for (size_t bit = 0; bit < length * 8; bit++) {
+            key[bit / 8] ^= static_cast<char>(1 << (bit % 8));
+            uint64_t changed = hash(key) ^ base;
+            key[bit / 8] ^= static_cast<char>(1 << (bit % 8));
+            for (int o = 0; o < output_bits; o++) {
+                flips[o] += (changed >> o) & 1;
+            }
+        }
+    }
+    double worst = 0;
+    for (int f: flips) {
+        worst = std::max(worst, std::abs(static_cast<double>(f) / (trials * length * 8) - 0.5));
+    }
+    std::printf("    %-10s worst output bit bias=%.3f\n", label, worst);
+}
+
+template<typename Hash>
+void throughput(const char *label, Hash hash, size_t length) {
+    // hashes a buffer of random keys of the given length for a while
+    std::mt19937 rng(5);
+    std::string buffer(length * 1024 + 64, '\0');
+    for (char &c: buffer) {
+        c = static_cast<char>('a' + rng() % 26);
+    }
+    uint64_t sink = 0;
+    size_t bytes = 0;
+    auto start = std::chrono::steady_clock::now();
+    double elapsed = 0;
+    while (elapsed < 0.2) {
+        for (size_t i = 0; i < 1024; i++) {
+            sink += hash(std::string_view(buffer.data() + i * length + i % 64, length));
+        }
+        bytes += length * 1024;
+        elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    double keys = bytes / static_cast<double>(length);
+    hash_sink = sink;
+    std::printf("    %-10s %7.2f ns/key %8.2f GB/s\n", label, elapsed * 1e9 / keys, bytes / elapsed / 1e9);
+}
+
+int main(int argc, char *argv[]) {
+    size_t n = argc > 1 ? std::stoull(argv[1]) : 1 << 20;
+    size_t lookups = argc > 2 ? std::stoull(argv[2]) : 2000000;
+
+    quality(n);
+
+    std::printf("avalanche\n");
+    for (size_t length: {8, 16, 64}) {
+        std::printf("  %zu byte keys\n", length);
+        avalanche("djb2", djb2, length, 32);
+        avalanche("hash_bytes", fast_bytes, length, 64);
+        avalanche("std::hash", std_bytes, length, 64);
+    }
+
+    std::printf("throughput\n");
+    for (size_t length: {8, 16, 32, 64, 256, 4096}) {
+        std::printf("  %zu byte keys\n", length);
+        throughput("djb2", djb2, length);
+        throughput("hash_bytes", fast_bytes, length);
+        throughput("std::hash", std_bytes, length);
+    }
+
+    // the command parser hands FileSystem a view into the input line
+    HashMap<std::string, int> files;
+    std::vector<std::string> lines;
+    for (size_t i = 0; i < n; i++) {
+        files.insert("file" + std::to_string(i) + ".txt", static_cast<int>(i));
+        lines.push_back("READ file" + std::to_string(i) + ".txt");
+    }
+    std::mt19937 rng(9);
+    std::vector<size_t> order(lookups);
+    for (size_t &i: order) {
+        i = rng() % n;
+    }
+    uint64_t sink = 0;
+    for (size_t i: order) {
+        sink += files.count(std::string_view(lines[i]).substr(5)); // warms the caches for both runs
+    }
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i: order) {
+        sink += files.count(std::string(std::string_view(lines[i]).substr(5)));
+    }
+    double copied = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    start = std::chrono::steady_clock::now();
+    for (size_t i: order) {
+        sink += files.count(std::string_view(lines[i]).substr(5));
+    }
+    double viewed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    std::printf("HashMap lookup of %zu file names: std::string %.1f ns/op, std::string_view %.1f ns/op%s\n", n,
+                copied / lookups, viewed / lookups, sink == 3 * lookups ? "" : " (missed keys)");
+    return 0;
+}
@@ -0,0 +1,217 @@
+// HashMap operations on the key shapes the file system uses: file names (FileSystem::files) and int keys
+// (IndexedHeap::ind_map). Compares the open addressing HashMap with the previous chained HashMap and
+// std::unordered_map.
+// usage: bench_hashmap [max_keys] [lookups]
+
+#include "HashMap.hpp"
+#include "Arena.hpp"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+template<typename K>
+struct LegacyHasher {
+    // previous hashing: djb2 for strings, identity for ints
+    unsigned int operator()(const K &key) const {
+        if constexpr (std::is_same_v<K, int>) {
+            return key;
+        } else {
+            unsigned long hash = 5381;
+            for (char c: key) {
+                hash = ((hash << 5) + hash) + c;
+            }
+            return hash;
+        }
+    }
+};
+
+template<typename K, typename V>
+class ChainedHashMap {
+    // previous layout: separate chaining with a pooled bucket per key
+    struct Bucket {
+        K key;
+        V value;
+        Bucket *next;
+    };
+
+    std::vector<Bucket *> table;
+    Pool<Bucket> buckets;
+    size_t current_size = 0;
+    LegacyHasher<K> hasher;
+
+    size_t hash(const K &key) const {
+        return hasher(key) % table.size();
+    }
+
+    void extend() {
+        std::vector<Bucket *> old = std::move(table);
+        table.assign(old.size() * 2, nullptr);
+        for (Bucket *current: old) {
+            while (current != nullptr) {
+                Bucket *next = current->next;
+                size_t idx = hash(current->key);
+                current->next = table[idx];
+                table[idx] = current;
+                current = next;
+            }
+        }
+    }
+
+public:
+    ChainedHashMap() : table(16, nullptr) {
+    }
+
+    ~ChainedHashMap() {
+        for (Bucket *current: table) {
+            while (current != nullptr) {
+                Bucket *next = current->next;
+                buckets.destroy(current);
+                current = next;
+            }
+        }
+    }
+
+    bool count(const K &key) const {
+        for (Bucket *current = table[hash(key)]; current != nullptr; current = current->next) {
+            if (current->key == key) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    const V &get(const K &key) const {
+        for (Bucket *current = table[hash(key)]; current != nullptr; current = current->next) {
+            if (current->key == key) {
+                return current->value;
+            }
+        }
+        throw std::out_of_range("Error: Key not found in HashMap.");
+    }
+
+    void insert(const K &key, const V &value) {
+        if (current_size >= table.size() * 3 / 4) {
+            extend();
+        }
+        size_t idx = hash(key);
+        for (Bucket *current = table[idx]; current != nullptr; current = current->next) {
+            if (current->key == key) {
+                current->value = value;
+                return;
+            }
+        }
+        table[idx] = buckets.create(Bucket{key, value, table[idx]});
+        current_size++;
+    }
+
+    void remove(const K &key) {
+        for (Bucket **link = &table[hash(key)]; *link != nullptr; link = &(*link)->next) {
+            if ((*link)->key == key) {
+                Bucket *todel = *link;
+                *link = todel->next;
+                buckets.destroy(todel);
+                current_size--;
+                return;
+            }
+        }
+    }
+};
+
+template<typename K, typename V>
+class StdHashMap {
+    // std::unordered_map behind the HashMap interface
+    std::unordered_map<K, V> map;
+
+public:
+    bool count(const K &key) const {
+        return map.count(key) != 0;
+    }
+
+    const V &get(const K &key) const {
+        return map.at(key);
+    }
+
+    void insert(const K &key, const V &value) {
+        map.insert_or_assign(key, value);
+    }
+
+    void remove(const K &key) {
+        map.erase(key);
+    }
+};
+
+template<typename Body>
+static double ns_per_op(size_t ops, Body body) {
+    auto start = std::chrono::steady_clock::now();
+    body();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / ops;
+}
+
+template<typename Map, typename K>
+void run(const char *label, const std::vector<K> &keys, const std::vector<K> &missing, size_t lookups) {
+    // insert every key, look up present keys the way FileSystem does (count, then get), look up absent keys,
+    // then remove and reinsert keys as IndexedHeap does on every pop and push
+    std::mt19937 rng(3);
+    std::vector<size_t> order(lookups);
+    for (size_t &i: order) {
+        i = rng() % keys.size();
+    }
+    size_t sink = 0;
+    Map map;
+    double insert = ns_per_op(keys.size(), [&] {
+        for (size_t i = 0; i < keys.size(); i++) {
+            map.insert(keys[i], static_cast<int>(i));
+        }
+    });
+    double hit = ns_per_op(lookups, [&] {
+        for (size_t i: order) {
+            if (map.count(keys[i])) {
+                sink += map.get(keys[i]);
+            }
+        }
+    });
+    double miss = ns_per_op(lookups, [&] {
+        for (size_t i: order) {
+            sink += map.count(missing[i]);
+        }
+    });
+    double churn = ns_per_op(lookups, [&] {
+        for (size_t i: order) {
+            map.remove(keys[i]);
+            map.insert(keys[i], static_cast<int>(i));
+        }
+    });
+    std::printf("  %-14s insert=%7.1f hit=%7.1f miss=%7.1f remove+insert=%7.1f ns/op%s\n", label, insert, hit, miss,
+                churn, sink == 0 ? " (no hits)" : "");
+}
+
+template<typename K>
+void compare(const char *shape, const std::vector<K> &keys, const std::vector<K> &missing, size_t lookups) {
+    std::printf("%s, %zu keys\n", shape, keys.size());
+    run<HashMap<K, int> >("HashMap", keys, missing, lookups);
+    run<ChainedHashMap<K, int> >("chained", keys, missing, lookups);
+    run<StdHashMap<K, int> >("unordered_map", keys, missing, lookups);
+}
+
+int main(int argc, char *argv[]) {
+    size_t max_keys = argc > 1 ? std::stoull(argv[1]) : 1000000;
+    size_t lookups = argc > 2 ? std::stoull(argv[2]) : 2000000;
+
+    for (size_t n = 1000; n <= max_keys; n *= 10) {
+        std::vector<std::string> names, absent;
+        std::vector<int> ids, absent_ids;
+        for (size_t i = 0; i < n; i++) {
+            names.push_back("file" + std::to_string(i) + ".txt");
+            absent.push_back("missing" + std::to_string(i) + ".txt");
+            ids.push_back(static_cast<int>(i));
+            absent_ids.push_back(static_cast<int>(i + n));
+        }
+        compare("file names", names, absent, lookups);
+        compare("int keys", ids, absent_ids, lookups);
+    }
+    return 0;
+}
@@ -0,0 +1,109 @@
+// IndexedHeap update and topk throughput for 2-, 4- and 8-ary layouts, and topk against the previous one that built
+// an auxiliary IndexedHeap on every call, with the allocations each makes.
+// usage: bench_heap [keys] [updates] [queries]
+
+#include "Heap.hpp"
+#include "CountingAllocator.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+template<typename Body>
+static double ns_per_op(size_t ops, Body body) {
+    auto start = std::chrono::steady_clock::now();
+    body();
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / ops;
+}
+
+struct ElementComparator {
+    // orders the elements of the previous topk's auxiliary heap by their value
+    greater<long long> comp;
+
+    bool operator()(const Element<int, long long> &lhs, const Element<int, long long> &rhs) const {
+        return comp(lhs.value, rhs.value);
+    }
+};
+
+std::vector<Element<int, long long> > legacy_topk(const std::vector<Element<int, long long> > &heap, int k) {
+    // previous topk over a binary heap array: a fresh IndexedHeap keyed by array index, holding element copies
+    std::vector<Element<int, long long> > ret;
+    k = std::min(k, static_cast<int>(heap.size()));
+    if (k <= 0) {
+        return ret;
+    }
+    IndexedHeap<int, Element<int, long long>, ElementComparator> aux_heap;
+    aux_heap.push(0, heap[0]);
+    for (int i = 0; i < k; i++) {
+        ret.push_back(aux_heap.top().value);
+        int cur = aux_heap.top().key;
+        aux_heap.pop();
+        for (int child = 2 * cur + 1; child <= 2 * cur + 2 && child < static_cast<int>(heap.size()); child++) {
+            aux_heap.push(child, heap[child]);
+        }
+    }
+    return ret;
+}
+
+template<int Arity>
+void run(int keys, const std::vector<std::pair<int, long long> > &updates, size_t queries) {
+    IndexedHeap<int, long long, greater<long long>, DenseIndex, Arity> heap;
+    for (int key = 0; key < keys; key++) {
+        heap.push(key, key);
+    }
+    double update = ns_per_op(updates.size(), [&] {
+        for (const std::pair<int, long long> &u: updates) {
+            heap.update(u.first, u.second);
+        }
+    });
+    long long sink = 0;
+    std::vector<Element<int, long long> > out;
+    std::printf("  %d-ary  update=%7.1f ns", Arity, update);
+    for (int k: {10, 1000}) {
+        heap.topk(k, out); // grows out and the frontier once
+        size_t before = allocations;
+        size_t rounds = k == 10 ? queries : queries / 100;
+        double top = ns_per_op(rounds, [&] {
+            for (size_t q = 0; q < rounds; q++) {
+                heap.topk(k, out);
+                sink += out.back().value;
+            }
+        });
+        std::printf("  top %d=%9.1f ns (%.1f allocs)", k, top, static_cast<double>(allocations - before) / rounds);
+    }
+    std::printf("%s\n", sink == 0 ? " (empty)" : "");
+    if constexpr (Arity == 2) {
+        std::printf("  previous topk       ");
+        for (int k: {10, 1000}) {
+            size_t before = allocations;
+            size_t rounds = k == 10 ? queries : queries / 100;
+            double top = ns_per_op(rounds, [&] {
+                for (size_t q = 0; q < rounds; q++) {
+                    sink += legacy_topk(heap.elements(), k).back().value;
+                }
+            });
+            std::printf("  top %d=%9.1f ns (%.1f allocs)", k, top,
+                        static_cast<double>(allocations - before) / rounds);
+        }
+        std::printf("\n");
+    }
+}
+
+int main(int argc, char *argv[]) {
+    int keys = argc > 1 ? std::stoi(argv[1]) : 1000000;
+    size_t update_count = argc > 2 ? std::stoull(argv[2]) : 4000000;
+    size_t queries = argc > 3 ? std::stoull(argv[3]) : 200000;
+
+    std::mt19937_64 rng(17);
+    std::vector<std::pair<int, long long> > updates(update_count);
+    for (std::pair<int, long long> &u: updates) {
+        u = {static_cast<int>(rng() % keys), static_cast<long long>(rng() % (4 * static_cast<uint64_t>(keys)))};
+    }
+    std::printf("%d keys, %zu random updates\n", keys, update_count);
+    run<2>(keys, updates, queries);
+    run<4>(keys, updates, queries);
+    run<8>(keys, updates, queries);
+    return 0;
+}
@@ -0,0 +1,94 @@
+// INSERT throughput on a file system with many files, and the update every INSERT makes to RECENT FILES: a move to
+// the front of the RecencyList against the previous heap keyed by interned file ID or by std::string.
+// usage: bench_ids [files] [inserts]
+
+#include "FileSystem.hpp"
+#include "Heap.hpp"
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+template<typename Body>
+static double seconds(Body body) {
+    auto start = std::chrono::steady_clock::now();
+    body();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+template<typename Heap, typename K>
+void heap_updates(const char *label, const std::vector<K> &keys, const std::vector<size_t> &order) {
+    // pushes every key, then moves random keys to the top the way a newer modification time does
+    Heap heap;
+    for (const K &key: keys) {
+        heap.push(key, 0);
+    }
+    time_t clock = 0;
+    double elapsed = seconds([&] {
+        for (size_t i: order) {
+            heap.update(keys[i], ++clock);
+        }
+    });
+    std::printf("  %-12s %7.1f ns/update %s\n", label, elapsed * 1e9 / order.size(),
+                heap.top().value == clock ? "" : "(wrong top)");
+}
+
+void recency_touches(const char *label, int keys, const std::vector<size_t> &order) {
+    // adds every key, then moves random keys to the front
+    RecencyList list;
+    for (int key = 0; key < keys; key++) {
+        list.touch(key);
+    }
+    double elapsed = seconds([&] {
+        for (size_t i: order) {
+            list.touch(static_cast<int>(i));
+        }
+    });
+    std::printf("  %-12s %7.1f ns/update %s\n", label, elapsed * 1e9 / order.size(),
+                list.front() == static_cast<int>(order.back()) ? "" : "(wrong front)");
+}
+
+int main(int argc, char *argv[]) {
+    int files = argc > 1 ? std::stoi(argv[1]) : 1000000;
+    size_t inserts = argc > 2 ? std::stoull(argv[2]) : 2000000;
+
+    std::vector<std::string> names;
+    std::vector<int> ids;
+    for (int i = 0; i < files; i++) {
+        names.push_back("file" + std::to_string(i) + ".txt");
+        ids.push_back(i);
+    }
+    std::mt19937 rng(7);
+    std::vector<size_t> order(inserts);
+    for (size_t &i: order) {
+        i = rng() % files;
+    }
+
+    std::printf("recent files, %d files\n", files);
+    heap_updates<IndexedHeap<std::string, time_t, greater<time_t> > >("name heap", names, order);
+    heap_updates<IndexedHeap<int, time_t, greater<time_t>, DenseIndex> >("ID heap", ids, order);
+    recency_touches("ID list", files, order);
+
+    std::streambuf *console = std::cout.rdbuf(nullptr);
+    double created, inserted;
+    {
+        FileSystem fs;
+        created = seconds([&] {
+            for (const std::string &name: names) {
+                fs.create(name);
+            }
+        });
+        inserted = seconds([&] {
+            for (size_t i: order) {
+                fs.insert(names[i], "x");
+            }
+        });
+    }
+    std::cout.rdbuf(console);
+    std::printf("file system, %d files\n", files);
+    std::printf("  CREATE %9.0f ops/s\n", files / created);
+    std::printf("  INSERT %9.0f ops/s\n", inserts / inserted);
+    return 0;
+}
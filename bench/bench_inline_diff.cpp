@@ -0,0 +1,112 @@
+// COMPARE --inline on long lines: pairs of 1k to 100k character lines with 0.1%, 2% and 20% of their characters edited
+// at random, aligned character by character by the bit-parallel LCS, by Myers and by the plain dynamic programming
+// LCS table, then refined end to end by changed_spans in chars and words mode. Throughput is given in LCS table cells
+// per nanosecond; each 64 cells the bit-parallel LCS reads two words and writes one.
+// usage: bench_inline_diff [max length]
+
+#include "Diff.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+int dynamic_lcs(const std::vector<int> &A, const std::vector<int> &B) {
+    // length of the LCS by the textbook table, one row at a time
+    std::vector<int> previous(B.size() + 1, 0), current(B.size() + 1, 0);
+    for (int a: A) {
+        for (size_t j = 0; j < B.size(); j++) {
+            current[j + 1] = a == B[j] ? previous[j] + 1 : std::max(previous[j + 1], current[j]);
+        }
+        std::swap(previous, current);
+    }
+    return previous[B.size()];
+}
+
+std::string generate(std::mt19937 &rng, size_t length) {
+    // words of code-like text separated by spaces and punctuation
+    static const char *words[] = {"value", "index", "count", "total", "x", "y", "result", "buffer", "size", "0"};
+    static const char *separators[] = {" ", ", ", " + ", "(", ") ", ".", " = "};
+    std::string line;
+    while (line.size() < length) {
+        line += words[rng() % 10];
+        line += separators[rng() % 7];
+    }
+    line.resize(length);
+    return line;
+}
+
+std::string edit(std::mt19937 &rng, const std::string &line, size_t edits) {
+    // line with edits random characters replaced, deleted or inserted
+    std::string edited = line;
+    for (size_t e = 0; e < edits; e++) {
+        size_t at = rng() % edited.size();
+        switch (rng() % 3) {
+            case 0:
+                edited[at] = static_cast<char>('a' + rng() % 26);
+                break;
+            case 1:
+                edited.erase(at, 1);
+                break;
+            default:
+                edited.insert(at, 1, static_cast<char>('a' + rng() % 26));
+                break;
+        }
+    }
+    return edited;
+}
+
+template<typename Run>
+double time_ms(Run run) {
+    // milliseconds run takes, repeated until at least 50 ms have passed
+    int repeats = 0;
+    auto start = std::chrono::steady_clock::now();
+    double elapsed;
+    do {
+        run();
+        repeats++;
+        elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    } while (elapsed < 50);
+    return elapsed / repeats;
+}
+
+int main(int argc, char *argv[]) {
+    size_t max_length = argc > 1 ? std::stoull(argv[1]) : 100000;
+
+    std::mt19937 rng(25);
+    std::printf("%8s %7s %22s %12s %22s %12s %12s\n", "length", "edited", "bit-parallel lcs", "myers",
+                "dynamic lcs", "chars spans", "words spans");
+    for (size_t length = 1000; length <= max_length; length *= 10) {
+        for (double rate: {0.001, 0.02, 0.2}) {
+            std::string from = generate(rng, length);
+            std::string to = edit(rng, from, std::max<size_t>(1, static_cast<size_t>(length * rate)));
+            std::vector<int> a(from.begin(), from.end()), b(to.begin(), to.end());
+            double cells = static_cast<double>(a.size()) * static_cast<double>(b.size());
+            std::vector<char> deleted, inserted;
+
+            double bit = time_ms([&] { BitParallelLcs(a, b, deleted, inserted).compare(); });
+            size_t bit_common = std::ranges::count(deleted, 0);
+            double myers = time_ms([&] { MyersDiff<int>(a, b, deleted, inserted).compare(); });
+            if (static_cast<size_t>(std::ranges::count(deleted, 0)) != bit_common) {
+                std::printf("LCS lengths differ\n");
+                return 1;
+            }
+            std::printf("%8zu %6.1f%% %9.3f ms %5.1f/ns %9.3f ms", length, rate * 100, bit, cells / bit / 1e6,
+                        myers);
+            if (length <= 10000) {
+                double table = time_ms([&] { dynamic_lcs(a, b); });
+                std::printf(" %9.3f ms %5.2f/ns", table, cells / table / 1e6);
+            } else {
+                std::printf(" %22s", "-");
+            }
+            std::vector<LineSpan> from_spans, to_spans;
+            for (InlineMode mode: {InlineMode::Chars, InlineMode::Words}) {
+                double spans = time_ms([&] { changed_spans(from, to, mode, from_spans, to_spans); });
+                std::printf(" %9.3f ms", spans);
+            }
+            std::printf("\n");
+        }
+    }
+    return 0;
+}
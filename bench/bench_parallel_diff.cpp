@@ -0,0 +1,104 @@
+// COMPARE's parallel diff: a pair of large versions with scattered edits, diffed by each algorithm without a pool and
+// then on pools of 1 to N threads. For each run, the time, the speedup over the diff without a pool, and whether the
+// output matches it.
+// usage: bench_parallel_diff [lines] [max threads]
+
+#include "Diff.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+std::string generate(std::mt19937 &rng, size_t lines) {
+    // code-like text: mostly distinct statements, with braces and blank lines repeating throughout
+    std::string text;
+    for (size_t i = 0; i < lines; i++) {
+        switch (rng() % 8) {
+            case 0:
+                text += "}\n";
+                break;
+            case 1:
+                text += "\n";
+                break;
+            default:
+                text += "    value_" + std::to_string(i) + " = compute(" + std::to_string(rng() % 100000) + ");\n";
+                break;
+        }
+    }
+    return text;
+}
+
+std::string edit(std::mt19937 &rng, const std::string &text, size_t edits) {
+    // text with edits random lines replaced, deleted or followed by a new line
+    std::vector<std::string_view> lines;
+    split_lines(text, lines);
+    std::vector<int> kind(lines.size(), 0);
+    for (size_t e = 0; e < edits; e++) {
+        kind[rng() % lines.size()] = 1 + static_cast<int>(rng() % 3);
+    }
+    std::string edited;
+    for (size_t i = 0; i < lines.size(); i++) {
+        if (kind[i] == 1) {
+            edited += "    edited(" + std::to_string(i) + ");\n";
+            continue;
+        }
+        if (kind[i] != 2) {
+            edited += lines[i];
+            edited += '\n';
+        }
+        if (kind[i] == 3) {
+            edited += "    inserted(" + std::to_string(i) + ");\n";
+        }
+    }
+    return edited;
+}
+
+double time_diff(const std::vector<std::string_view> &from, const std::vector<std::string_view> &to,
+                 DiffAlgorithm algorithm, ThreadPool *pool, std::vector<DiffLine> &lines) {
+    // milliseconds the diff takes
+    auto start = std::chrono::steady_clock::now();
+    lines = diff(from, to, algorithm, pool);
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool same(const std::vector<DiffLine> &x, const std::vector<DiffLine> &y) {
+    // whether two diffs are identical
+    return std::equal(x.begin(), x.end(), y.begin(), y.end(), [](const DiffLine &p, const DiffLine &q) {
+        return p.c == q.c && p.line == q.line;
+    });
+}
+
+int main(int argc, char *argv[]) {
+    size_t total = argc > 1 ? std::stoull(argv[1]) : 1000000;
+    int max_threads = argc > 2 ? std::stoi(argv[2])
+                              : static_cast<int>(std::max(4u, std::thread::hardware_concurrency()));
+
+    std::mt19937 rng(24);
+    std::string from_text = generate(rng, total);
+    std::string to_text = edit(rng, from_text, total / 500);
+    std::vector<std::string_view> from, to;
+    split_lines(from_text, from);
+    split_lines(to_text, to);
+    std::printf("%zu lines, %zu edits, %u hardware threads\n\n", from.size(), total / 500,
+                std::thread::hardware_concurrency());
+
+    std::printf("%-10s %-12s %12s %9s %8s\n", "algorithm", "threads", "time", "speedup", "output");
+    for (DiffAlgorithm algorithm: {DiffAlgorithm::Myers, DiffAlgorithm::Patience, DiffAlgorithm::Histogram}) {
+        const char *name = algorithm == DiffAlgorithm::Myers
+                               ? "myers"
+                               : algorithm == DiffAlgorithm::Patience ? "patience" : "histogram";
+        std::vector<DiffLine> reference, lines;
+        double base = time_diff(from, to, algorithm, nullptr, reference);
+        std::printf("%-10s %-12s %9.2f ms %8.2fx %8s\n", name, "no pool", base, 1.0, "");
+        for (int threads = 1; threads <= max_threads; threads *= 2) {
+            ThreadPool pool(threads);
+            double ms = time_diff(from, to, algorithm, &pool, lines);
+            std::printf("%-10s %-12d %9.2f ms %8.2fx %8s\n", name, threads, ms, base / ms,
+                        same(reference, lines) ? "same" : "DIFFERS");
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,54 @@
+// Compares full and delta version storage: bytes per version and READ latency.
+// usage: bench_storage [versions] [keyframe_interval]
+
+#include "File.hpp"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+
+static void grow(File &file, BlobStore &store, int versions, std::mt19937 &rng) {
+    // builds a chain of versions, mostly appends with an occasional in-place line edit
+    for (int v = 1; v < versions; v++) {
+        if (rng() % 4 == 0 && file.content(file.active_version).size() > 0) {
+            std::string text = file.content(file.active_version).str();
+            size_t at = rng() % text.size();
+            text.insert(at, "edited line " + std::to_string(v) + "\n");
+            file.newversion(Rope(store, text), file.active_version, file.total_versions, true);
+        } else {
+            std::string line = "appended line " + std::to_string(v) + " with some payload text\n";
+            file.newversion(file.content(file.active_version) + Rope(store, line), file.active_version,
+                            file.total_versions);
+        }
+        file.snapshot("v" + std::to_string(v));
+    }
+}
+
+static void run(const char *label, StorageMode mode, int versions, int keyframe_interval) {
+    std::mt19937 rng(42);
+    BlobStore store;
+    size_t nodes_before = Rope::live_nodes();
+    File file("bench.txt", "", store, mode, keyframe_interval);
+    grow(file, store, versions, rng);
+    size_t bytes = store.bytes_stored() + (Rope::live_nodes() - nodes_before) * sizeof(RopeNode);
+
+    const int reads = 2000;
+    size_t checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < reads; i++) {
+        checksum += file.content(rng() % versions).str().size();
+    }
+    auto end = std::chrono::steady_clock::now();
+    double read_us = std::chrono::duration<double, std::micro>(end - start).count() / reads;
+
+    std::printf("%-6s versions=%d bytes/version=%.1f read=%.2fus (checksum %zu)\n", label, versions,
+                static_cast<double>(bytes) / versions, read_us, checksum);
+}
+
+int main(int argc, char *argv[]) {
+    int versions = argc > 1 ? std::stoi(argv[1]) : 2000;
+    int keyframe_interval = argc > 2 ? std::stoi(argv[2]) : 16;
+    run("full", StorageMode::Full, versions, keyframe_interval);
+    run("delta", StorageMode::Delta, versions, keyframe_interval);
+    return 0;
+}
@@ -0,0 +1,138 @@
+// VERSIONS and HISTORY on a large version tree: struct-of-arrays VersionTable against the previous
+// pointer-linked TreeNode layout.
+// usage: bench_versions [versions]
+
+#include "File.hpp"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <ranges>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+struct NullBuffer : std::streambuf {
+    // discards everything written to it
+    int overflow(int c) override {
+        return c;
+    }
+
+    std::streamsize xsputn(const char *, std::streamsize n) override {
+        return n;
+    }
+};
+
+struct PointerNode {
+    // previous layout: one heap node per version linked by pointers
+    int version_id;
+    std::string content;
+    std::string message;
+    time_t created_timestamp;
+    time_t snapshot_timestamp;
+    PointerNode *parent;
+    std::vector<PointerNode *> children;
+
+    bool isSnapshot() const {
+        return message.length() != 0;
+    }
+};
+
+template<typename Body>
+static double timed_ms(Body body) {
+    auto start = std::chrono::steady_clock::now();
+    body();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+int main(int argc, char *argv[]) {
+    int total = argc > 1 ? std::stoi(argv[1]) : 1000000;
+    std::mt19937 rng(7);
+
+    // long edit chains with occasional branches, every other version snapshotted
+    BlobStore store;
+    File file("bench.txt", "", store);
+    for (int v = 1; v < total; v++) {
+        int parent = (rng() % 16 == 0) ? static_cast<int>(rng() % v) : file.active_version;
+        if (!(file.isSnapshot(parent))) {
+            parent = file.parent(parent);
+        }
+        file.newversion(file.content(parent), parent, v);
+        if (v % 2 == 0) {
+            file.snapshot("snapshot " + std::to_string(v));
+        }
+    }
+
+    std::vector<PointerNode *> nodes(total);
+    for (int v = 0; v < total; v++) {
+        nodes[v] = new PointerNode{
+            v, "", std::string(file.versions.message(v)), file.versions.created_timestamp[v],
+            file.versions.snapshot_timestamp[v], nullptr, {}
+        };
+        if (file.parent(v) != -1) {
+            nodes[v]->parent = nodes[file.parent(v)];
+            nodes[file.parent(v)]->children.push_back(nodes[v]);
+        }
+    }
+    PointerNode *active = nodes[file.active_version];
+
+    NullBuffer null_buffer;
+    std::streambuf *console = std::cout.rdbuf(&null_buffer);
+
+    double soa_versions = timed_ms([&] { file.print_versions(); });
+    double pointer_versions = timed_ms([&] {
+        for (int i = 0; i < total; i++) {
+            PointerNode *current_v = nodes[i];
+            std::cout << "v" << i << (current_v->isSnapshot() ? " is a snapshot" : "") << (
+                (i == active->version_id) ? " is active " : " ");
+            (current_v->version_id == 0)
+                ? std::cout << "is root.\n"
+                : std::cout << "with parent v" << current_v->parent->version_id << "\n";
+        }
+    });
+
+    const int history_rounds = 20;
+    double soa_history = timed_ms([&] {
+        for (int i = 0; i < history_rounds; i++) {
+            file.print_history();
+        }
+    }) / history_rounds;
+    double pointer_history = timed_ms([&] {
+        for (int i = 0; i < history_rounds; i++) {
+            PointerNode *current = active;
+            std::vector<PointerNode *> snapshots;
+            while (current->parent != nullptr) {
+                if (current->isSnapshot()) {
+                    snapshots.push_back(current);
+                }
+                current = current->parent;
+            }
+            snapshots.push_back(current);
+            for (PointerNode *snap: std::ranges::reverse_view(snapshots)) {
+                std::cout << "VersionID : " << snap->version_id << " TimeStamp : "
+                        << timeToString(snap->snapshot_timestamp) << " Message : " << snap->message << "\n";
+            }
+        }
+    }) / history_rounds;
+
+    size_t leaves = 0;
+    double soa_scan = timed_ms([&] {
+        for (int v = 0; v < total; v++) {
+            leaves += file.versions.children(v).empty();
+        }
+    });
+
+    std::cout.rdbuf(console);
+    int depth = 0;
+    for (int v = file.active_version; v != -1; v = file.parent(v)) {
+        depth++;
+    }
+    std::printf("versions=%d active depth=%d leaves=%zu\n", total, depth, leaves);
+    std::printf("VERSIONS: soa %.1fms, pointers %.1fms\n", soa_versions, pointer_versions);
+    std::printf("HISTORY:  soa %.2fms, pointers %.2fms\n", soa_history, pointer_history);
+    std::printf("children scan (CSR build + walk): %.1fms\n", soa_scan);
+    for (PointerNode *node: nodes) {
+        delete node;
+    }
+    return 0;
+}
@@ -4,6 +4,9 @@
 #include <cctype>
 #include <sstream>
 #include <iomanip>
+#include <memory>
+#include <charconv>
+#include <filesystem>
 
 std::string rawinput() {
     // function to take multi-line input
@@ -39,8 +42,208 @@ void toLower(std::string &s) {
     }
 }
 
-int main() {
-    FileSystem fs;
+class CommandArgs {
+    // Splits a command line into views of its words without copying it. Quoted words follow std::quoted: they may
+    // contain spaces, and only one with a backslash escape is copied to unescape it.
+private:
+    static constexpr std::string_view spaces = " \t\n\v\f\r";
+    std::string_view rest; // not yet parsed
+    std::string unescaped; // last quoted word that had escapes
+
+    bool skip_spaces() {
+        // drops leading whitespace, false if nothing is left
+        size_t start = rest.find_first_not_of(spaces);
+        rest.remove_prefix(start == std::string_view::npos ? rest.size() : start);
+        return !rest.empty();
+    }
+
+public:
+    explicit CommandArgs(std::string_view line) : rest(line) {
+    }
+
+    bool word(std::string_view &out) {
+        // next whitespace separated word
+        if (!skip_spaces()) {
+            return false;
+        }
+        out = rest.substr(0, rest.find_first_of(spaces));
+        rest.remove_prefix(out.size());
+        return true;
+    }
+
+    bool quoted(std::string_view &out) {
+        // next word, or the text between double quotes if it starts with one, false if the quote is not closed
+        if (!skip_spaces()) {
+            return false;
+        }
+        if (rest.front() != '"') {
+            return word(out);
+        }
+        rest.remove_prefix(1);
+        size_t end = rest.find_first_of("\"\\");
+        if (end == std::string_view::npos) {
+            return false;
+        }
+        if (rest[end] == '"') {
+            out = rest.substr(0, end);
+            rest.remove_prefix(end + 1);
+            return true;
+        }
+        unescaped.clear();
+        while (!rest.empty() && rest.front() != '"') {
+            if (rest.front() == '\\' && rest.size() > 1) {
+                rest.remove_prefix(1);
+            }
+            unescaped.push_back(rest.front());
+            rest.remove_prefix(1);
+        }
+        if (rest.empty()) {
+            return false;
+        }
+        rest.remove_prefix(1);
+        out = unescaped;
+        return true;
+    }
+
+    template<typename T>
+    bool number(T &out) {
+        // next integer, read like operator>> up to the first character that is not part of it
+        if (!skip_spaces()) {
+            return false;
+        }
+        size_t sign = rest.front() == '+' ? 1 : 0;
+        auto [end, error] = std::from_chars(rest.data() + sign, rest.data() + rest.size(), out);
+        if (error != std::errc()) {
+            return false;
+        }
+        rest.remove_prefix(end - rest.data());
+        return true;
+    }
+};
+
+struct Options {
+    // command line options
+    StorageMode mode = StorageMode::Full;
+    int keyframe_interval = 16;
+    std::string journal_path; // empty if journaling is off
+    std::string checkpoint_path; // empty if checkpoints are off
+    std::string cold_store_path; // empty if all contents stay in memory
+    size_t memory_budget = size_t(64) << 20;
+    int compress_after = 0; // commands a content stays unread before it is compressed, 0 if off
+    int diff_threads = 1; // threads COMPARE splits large diffs across
+    FsyncPolicy fsync_policy = FsyncPolicy::PerOp;
+    int group_size = 32;
+    int interval_ms = 100;
+};
+
+size_t parseSize(const std::string &text) {
+    // parses a byte count with an optional K, M or G suffix
+    size_t used;
+    unsigned long long value = std::stoull(text, &used);
+    std::string suffix = text.substr(used);
+    toLower(suffix);
+    if (suffix == "k") {
+        value <<= 10;
+    } else if (suffix == "m") {
+        value <<= 20;
+    } else if (suffix == "g") {
+        value <<= 30;
+    } else if (!suffix.empty()) {
+        throw std::invalid_argument("Invalid size '" + text + "'.");
+    }
+    return static_cast<size_t>(value);
+}
+
+Options parseOptions(int argc, char *argv[]) {
+    // function to parse command line options
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--storage=full") {
+            options.mode = StorageMode::Full;
+        } else if (arg == "--storage=delta") {
+            options.mode = StorageMode::Delta;
+        } else if (arg.starts_with("--keyframe=")) {
+            options.keyframe_interval = std::stoi(arg.substr(std::string("--keyframe=").size()));
+        } else if (arg.starts_with("--journal=")) {
+            options.journal_path = arg.substr(std::string("--journal=").size());
+        } else if (arg.starts_with("--checkpoint=")) {
+            options.checkpoint_path = arg.substr(std::string("--checkpoint=").size());
+        } else if (arg.starts_with("--cold-store=")) {
+            options.cold_store_path = arg.substr(std::string("--cold-store=").size());
+        } else if (arg.starts_with("--memory-budget=")) {
+            options.memory_budget = parseSize(arg.substr(std::string("--memory-budget=").size()));
+        } else if (arg.starts_with("--compress-after=")) {
+            options.compress_after = std::stoi(arg.substr(std::string("--compress-after=").size()));
+        } else if (arg.starts_with("--diff-threads=")) {
+            options.diff_threads = std::stoi(arg.substr(std::string("--diff-threads=").size()));
+        } else if (arg == "--fsync=op") {
+            options.fsync_policy = FsyncPolicy::PerOp;
+        } else if (arg.starts_with("--fsync=group")) {
+            options.fsync_policy = FsyncPolicy::Group;
+            if (arg.starts_with("--fsync=group:")) {
+                options.group_size = std::stoi(arg.substr(std::string("--fsync=group:").size()));
+            }
+        } else if (arg.starts_with("--fsync=interval")) {
+            options.fsync_policy = FsyncPolicy::Interval;
+            if (arg.starts_with("--fsync=interval:")) {
+                options.interval_ms = std::stoi(arg.substr(std::string("--fsync=interval:").size()));
+            }
+        } else {
+            throw std::invalid_argument("Unknown option '" + arg + "'.");
+        }
+    }
+    return options;
+}
+
+int main(int argc, char *argv[]) {
+    Options options;
+    try {
+        options = parseOptions(argc, argv);
+    } catch (const std::exception &e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        std::cerr << "usage: cgfs [--storage=full|delta] [--keyframe=K] [--journal=PATH]"
+                " [--fsync=op|group[:N]|interval[:MS]] [--checkpoint=PATH] [--cold-store=DIR]"
+                " [--memory-budget=SIZE] [--compress-after=N] [--diff-threads=N]\n";
+        return 1;
+    }
+    FileSystem fs(options.mode, options.keyframe_interval);
+    try {
+        if (!options.cold_store_path.empty()) {
+            fs.enable_cold_store(options.cold_store_path, options.memory_budget);
+        }
+        fs.enable_compression(options.compress_after);
+        fs.enable_parallel_diff(options.diff_threads);
+    } catch (const std::exception &e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    if (!options.checkpoint_path.empty() && std::filesystem::exists(options.checkpoint_path)) {
+        try {
+            fs.load_checkpoint(options.checkpoint_path);
+            std::cout << "Loaded checkpoint " << fs.current_checkpoint() << " with " << fs.file_count()
+                    << " files from '" << options.checkpoint_path << "'.\n";
+        } catch (const std::exception &e) {
+            std::cerr << "Error: " << e.what() << "\n";
+            return 1;
+        }
+    }
+    std::unique_ptr<Journal> journal;
+    if (!options.journal_path.empty()) {
+        try {
+            size_t recovered = fs.replay(Journal::load(options.journal_path));
+            journal = std::make_unique<Journal>(options.journal_path, options.fsync_policy, options.group_size,
+                                                options.interval_ms);
+            fs.attach_journal(journal.get());
+            if (recovered > 0) {
+                std::cout << "Recovered " << recovered << " operations from journal '" << options.journal_path
+                        << "'.\n";
+            }
+        } catch (const std::exception &e) {
+            std::cerr << "Error: " << e.what() << "\n";
+            return 1;
+        }
+    }
     std::string line;
     std::cout << "Welcome to COL106 Git v1.0.0\n";
     std::cout << "Enter 'exit' to quit.\n";
@@ -54,9 +257,9 @@ int main() {
             std::cout << "Exiting COL106 Git v1.0.0. Bye!\n";
             break;
         }
-        std::stringstream ss(line);
-        std::string command;
-        ss >> command;
+        CommandArgs args(line);
+        std::string_view word;
+        std::string command(args.word(word) ? word : std::string_view());
         toLower(command);
 
         try {
@@ -80,19 +283,30 @@ int main() {
         ROLLBACK <filename> [versionID]                 : Sets the active version pointer to the specified versionID.
                                                           If no ID is provided, it rolls back to the parent of the current
                                                           active version.
-        HISTORY <filename>                              : Lists all snapshotted versions of the file chronologically,
+        HISTORY <filename> [limit]                      : Lists all snapshotted versions of the file chronologically,
                                                           which lie on the path from active node to the root in the file
-                                                          tree, showing their ID, timestamp, and message.
+                                                          tree, showing their ID, timestamp, and message. If limit is
+                                                          given, only the limit most recent of them are listed.
         RECENT FILES [num]                              : Lists files in descending order of their last modification time
                                                           restricted to the first num entries. If no num is provided, it
                                                           shows all files.
         BIGGEST TREES [num]                             : Lists files in descending order of their total version count
                                                           restricted to the first num entries. If no num is provided, it
                                                           shows all files.
+        MODIFIED <from> <to> [limit] [cursor]           : Lists files last modified between the Unix times from and to
+                                                          (inclusive), oldest first. If limit is given, only limit files
+                                                          are listed, followed by a cursor to pass for the next page.
         DETAILS <filename>                              : Shows summary of file.
         VERSIONS <filename>                             : Shows details of all versions of file.
         COMPARE <filename> <versionID-1> [versionID-2]  : Shows the diff versionID-1 -> versionID-2. If not provided,
-                                                          default versionID-2 is active-version.
+                [--algo=myers|patience|histogram]         default versionID-2 is active-version. --algo picks the
+                [--inline=none|chars|words]               diff algorithm, myers (shortest diff) by default. --inline
+                                                          highlights the changed characters or words of changed
+                                                          lines, none by default.
+        STATS                                           : Shows storage statistics, including the deduplication ratio
+                                                          of version contents.
+        CHECKPOINT                                      : Writes a binary image of the whole file system to the
+                                                          --checkpoint path and restarts the journal from it.
         help                                            : Displays this message.
         exit                                            : Quit.
     MultiLine Content and Message:
@@ -102,100 +316,145 @@ int main() {
 )";
                 std::cout << help;
             } else if (command == "create") {
-                std::string filename;
-                if (!(ss >> std::quoted(filename))) {
+                std::string_view filename;
+                if (!args.quoted(filename)) {
                     throw std::invalid_argument("CREATE requires a filename.");
                 }
                 fs.create(filename);
             } else if (command == "read") {
-                std::string filename;
-                if (!(ss >> std::quoted(filename))) {
+                std::string_view filename;
+                if (!args.quoted(filename)) {
                     throw std::invalid_argument("READ requires a filename.");
                 }
                 std::cout << fs.read(filename) << "\n";
             } else if (command == "insert") {
-                std::string filename;
-                if (!(ss >> std::quoted(filename))) {
+                std::string_view filename;
+                if (!args.quoted(filename)) {
                     throw std::invalid_argument("INSERT requires a filename.");
                 }
                 std::cout << "Enter content (end with 'Ctrl+G'):\n";
                 std::string content = rawinput();
                 fs.insert(filename, content);
             } else if (command == "update") {
-                std::string filename;
-                if (!(ss >> std::quoted(filename))) {
+                std::string_view filename;
+                if (!args.quoted(filename)) {
                     throw std::invalid_argument("UPDATE requires a filename.");
                 }
                 std::cout << "Enter content (end with 'Ctrl+G'):\n";
                 std::string content = rawinput();
                 fs.update(filename, content);
             } else if (command == "snapshot") {
-                std::string filename;
-                if (!(ss >> std::quoted(filename))) {
+                std::string_view filename;
+                if (!args.quoted(filename)) {
                     throw std::invalid_argument("SNAPSHOT requires a filename.");
                 }
                 std::cout << "Enter snapshot message (end with 'Ctrl+G'):\n";
                 std::string message = rawinput();
                 fs.snapshot(filename, message);
             } else if (command == "rollback") {
-                std::string filename;
+                std::string_view filename;
                 int versionID;
-                if (!(ss >> std::quoted(filename))) {
+                if (!args.quoted(filename)) {
                     throw std::invalid_argument("ROLLBACK requires a filename.");
                 }
-                if (ss >> versionID) {
+                if (args.number(versionID)) {
                     fs.rollback(filename, versionID);
                 } else {
                     fs.rollback(filename);
                 }
             } else if (command == "history") {
-                std::string filename;
-                if (!(ss >> std::quoted(filename))) {
+                std::string_view filename;
+                if (!args.quoted(filename)) {
                     throw std::invalid_argument("HISTORY requires a filename.");
                 }
-                fs.history(filename);
+                int limit;
+                if (args.number(limit)) {
+                    fs.history(filename, limit);
+                } else {
+                    fs.history(filename);
+                }
             } else if (command == "details") {
-                std::string filename;
-                if (!(ss >> std::quoted(filename))) {
+                std::string_view filename;
+                if (!args.quoted(filename)) {
                     throw std::invalid_argument("DETAILS requires a filename.");
                 }
                 fs.details(filename);
             } else if (command == "versions") {
-                std::string filename;
-                if (!(ss >> std::quoted(filename))) {
+                std::string_view filename;
+                if (!args.quoted(filename)) {
                     throw std::invalid_argument("VERSIONS requires a filename.");
                 }
                 fs.versions(filename);
             } else if (command == "compare") {
-                std::string filename;
-                int v1, v2;
-                if (!(ss >> std::quoted(filename) >> v1)) {
+                std::string_view filename;
+                int v1, v2 = -1;
+                if (!(args.quoted(filename) && args.number(v1))) {
                     throw std::invalid_argument("COMPARE requires a filename and at least one VersionID.");
                 }
-                if (ss >> v2) {
-                    fs.compare(filename, v1, v2);
-                } else {
-                    fs.compare(filename, v1);
+                args.number(v2);
+                DiffAlgorithm algorithm = DiffAlgorithm::Myers;
+                InlineMode inline_mode = InlineMode::None;
+                std::string_view option;
+                while (args.word(option)) {
+                    if (option.starts_with("--algo=")) {
+                        algorithm = parse_diff_algorithm(option.substr(std::string_view("--algo=").size()));
+                    } else if (option.starts_with("--inline=")) {
+                        inline_mode = parse_inline_mode(option.substr(std::string_view("--inline=").size()));
+                    } else {
+                        throw std::invalid_argument("Unknown COMPARE option '" + std::string(option) + "'.");
+                    }
                 }
+                fs.compare(filename, v1, v2, algorithm, inline_mode);
             } else if (command == "recentfiles" || command == "recent" || command == "recent_files") {
                 int num;
-                if (ss >> num) {
+                if (args.number(num)) {
                     fs.print_recent_files(num);
                 } else {
                     fs.print_recent_files();
                 }
             } else if (command == "biggesttrees" || command == "biggest" || command == "biggest_trees") {
                 int num;
-                if (ss >> num) {
+                if (args.number(num)) {
                     fs.print_biggest_trees(num);
                 } else {
                     fs.print_biggest_trees();
                 }
+            } else if (command == "modified") {
+                time_t from, to;
+                int limit;
+                if (!(args.number(from) && args.number(to))) {
+                    throw std::invalid_argument("MODIFIED requires a start and an end time.");
+                }
+                std::string_view cursor;
+                if (!args.number(limit)) {
+                    fs.print_modified(from, to);
+                } else if (!args.word(cursor)) {
+                    fs.print_modified(from, to, limit);
+                } else {
+                    // cursor printed by the previous page: <time>:<fileID>
+                    SkipList<time_t>::Position after;
+                    size_t colon = cursor.find(':');
+                    const char *end = cursor.data() + cursor.size();
+                    if (colon == std::string_view::npos ||
+                        std::from_chars(cursor.data(), cursor.data() + colon, after.value).ptr != cursor.data() + colon ||
+                        std::from_chars(cursor.data() + colon + 1, end, after.key).ptr != end) {
+                        throw std::invalid_argument("MODIFIED cursor must be <time>:<fileID> as printed.");
+                    }
+                    fs.print_modified(from, to, limit, after);
+                }
+            } else if (command == "stats") {
+                fs.stats();
+            } else if (command == "checkpoint") {
+                if (options.checkpoint_path.empty()) {
+                    throw std::invalid_argument("CHECKPOINT requires the --checkpoint=PATH option.");
+                }
+                fs.checkpoint(options.checkpoint_path);
             } else if (command.empty()) {
                 std::cout << "Please enter a command.\n";
             } else {
                 std::cerr << "Error: Unknown Command '" << command << "'.\n";
             }
+            fs.maintain(); // contents printed by the command are no longer needed in memory
         } catch (const std::exception &e) {
             // else shows exception and continues loop
             std::cerr << "Operation failed: " << e.what() << "\n";
@@ -2,7 +2,7 @@
 echo Compiling project...
 
 :: Compile main.cpp into CGFS.exe
-g++ -std=c++23 -o CGFS.exe main.cpp
+g++ -std=c++23 -pthread -o CGFS.exe main.cpp
 
 :: Check if compilation was successful before running
 if %errorlevel% == 0 (
@@ -3,7 +3,7 @@
 echo "Compiling project..."
 
 # Compile main.cpp into an executable named 'cgfs_run'
-g++ -std=c++23 -o cgfs_run main.cpp
+g++ -std=c++23 -pthread -o cgfs_run main.cpp
 
 # Check if the compilation command succeeded ($? is the exit code)
 if [ $? -eq 0 ]; then